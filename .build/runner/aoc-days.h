@@ -0,0 +1,11 @@
+AOC_DAY(aoc_2025_01, "2025/01")
+AOC_DAY(aoc_2025_02, "2025/02")
+AOC_DAY(aoc_2025_03, "2025/03")
+AOC_DAY(aoc_2025_04, "2025/04")
+AOC_DAY(aoc_2025_05, "2025/05")
+AOC_DAY(aoc_2025_06, "2025/06")
+AOC_DAY(aoc_2025_07, "2025/07")
+AOC_DAY(aoc_2025_08, "2025/08")
+AOC_DAY(aoc_2025_09, "2025/09")
+AOC_DAY(aoc_2025_10, "2025/10")
+AOC_DAY(aoc_2025_11, "2025/11")
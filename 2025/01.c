@@ -1,56 +1,287 @@
 #include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
-void part1(char const *input) {
-  size_t skip, zeros = 0;
-  int clicks, dial = 50;
-  char dir;
+#include <aoc-command.h>
+#include <aoc-parse.h>
+#include <aoc-stream.h>
+#include <aoc-thread.h>
+#include <aoc-trace.h>
+
+// Inputs shorter than this are summarized on the calling thread alone.
+#define PARALLEL_BYTES (1024 * 1024)
+
+typedef struct dial {
+  int position;
+  uint64_t zeros;
+} dial;
+
+static void rotate1(dial *d, char dir, int clicks) {
+  assert(0 <= d->position && d->position < 100);
+  assert(dir == 'L' || dir == 'R');
+
+  d->position += (dir == 'L') ? -clicks : clicks;
+  d->position %= 100;
+
+  if (d->position < 0) {
+    d->position += 100;
+  }
+  d->zeros += (d->position == 0);
+}
 
-  while (sscanf(input, "%c%d\n%zn", &dir, &clicks, &skip) == 2) {
-    assert(0 <= dial && dial < 100);
-    assert(dir == 'L' || dir == 'R');
+static void rotate2(dial *d, char dir, int clicks) {
+  assert(0 <= d->position && d->position < 100);
+  assert(dir == 'L' || dir == 'R');
 
-    dial += (dir == 'L') ? -clicks : clicks;
-    dial %= 100;
+  d->zeros += clicks / 100;
+  clicks %= 100;
 
-    if (dial < 0) {
-      dial += 100;
+  if (dir == 'L') {
+    d->zeros += (d->position > 0 && d->position - clicks <= 0);
+    d->position -= clicks;
+    if (d->position < 0) {
+      d->position = 100 + d->position;
     }
-    zeros += (dial == 0);
-    input += skip;
+  } else {
+    d->position += clicks;
+    if (d->position >= 100) {
+      d->zeros++;
+      d->position -= 100;
+    }
+  }
+}
+
+// Parse one rotation such as "L68" and advance past it and its line break.
+static bool next(char const **input, char *dir, int *clicks) {
+  char const *text = *input;
+  uint64_t value;
+
+  if (*text == '\0') return false;
+  *dir = *text++;
+  if (!aoc_parse_u64(&text, &value)) return false;
+  aoc_parse_space(&text);
+
+  *clicks = (int)value;
+  *input = text;
+  return true;
+}
+
+// The effect of a run of rotations on a dial starting at any position. Where
+// the dial ends up only depends on the net `offset`, and each rotation passes
+// zero for a contiguous (wrapping) range of starting positions, so a summary
+// costs constant time per rotation however many starts it covers.
+typedef struct summary {
+  int offset;
+  // Part 1: the number of rotations that end on zero, by starting position.
+  uint64_t lands[100];
+  // Part 2: full turns count for every start. Other passes over zero are kept
+  // as a difference array over starting positions until summary_finish.
+  uint64_t turns;
+  uint64_t passes[101];
+} summary;
+
+// Add one to passes[start] for the `count` starting positions from `start`,
+// wrapping around past 99.
+static void summary_mark(summary *s, int start, int count) {
+  if (count == 0) return;
+
+  s->passes[start]++;
+  if (start + count <= 100) {
+    s->passes[start + count]--;
+  } else {
+    s->passes[100]--;
+    s->passes[0]++;
+    s->passes[start + count - 100]--;
+  }
+}
+
+static void summary_rotate(summary *s, char dir, int clicks) {
+  int partial = clicks % 100;
+
+  assert(dir == 'L' || dir == 'R');
+
+  // Going right from p, zero is passed when p + partial reaches 100; going
+  // left, when p is positive and p - partial is at most zero. The dial is at
+  // p = (start + offset) % 100, which gives the range of starts.
+  s->turns += clicks / 100;
+  if (dir == 'R') {
+    summary_mark(s, (200 - partial - s->offset) % 100, partial);
+    s->offset = (s->offset + partial) % 100;
+  } else {
+    summary_mark(s, (101 - s->offset) % 100, partial);
+    s->offset = (s->offset + 100 - partial) % 100;
+  }
+
+  s->lands[(100 - s->offset) % 100]++;
+}
+
+// Turn the difference array into a count of passes per starting position.
+static void summary_finish(summary *s) {
+  int i;
+
+  for (i = 1; i < 100; i++) {
+    s->passes[i] += s->passes[i - 1];
   }
+}
+
+typedef struct solver {
+  char const *input;
+  size_t length;
+  summary *chunks;
+} solver;
 
-  printf("%zu\n", zeros);
+// Return the start of the line that offset `at` falls in the middle of, or
+// `at` itself if it is already the start of a line.
+static size_t line_start(solver const *sv, size_t at) {
+  char const *newline;
+
+  if (at == 0 || at >= sv->length || sv->input[at - 1] == '\n') return at;
+  newline = memchr(sv->input + at, '\n', sv->length - at);
+  return newline ? (size_t)(newline - sv->input) + 1 : sv->length;
 }
 
-void part2(char const *input) {
-  size_t skip, zeros = 0;
-  int clicks, dial = 50;
+static void summarize(void *ctx, size_t id, size_t count) {
+  solver *sv = ctx;
+  summary *s = &sv->chunks[id];
+  char const *text = sv->input + line_start(sv, sv->length * id / count);
+  char const *end = sv->input + line_start(sv, sv->length * (id + 1) / count);
+  int clicks;
   char dir;
 
-  while (sscanf(input, "%c%d\n%zn", &dir, &clicks, &skip) == 2) {
-    assert(0 <= dial && dial < 100);
-    assert(dir == 'L' || dir == 'R');
+  memset(s, 0, sizeof(*s));
+  while (text < end && next(&text, &dir, &clicks)) {
+    summary_rotate(s, dir, clicks);
+  }
+  summary_finish(s);
+}
+
+// Summarize the rotations in `input` in chunks, one per thread for large
+// inputs. Returns the chunk summaries, in order.
+static summary *solve(char const *input, size_t *nchunks) {
+  solver sv = {input, strlen(input)};
+
+  *nchunks = sv.length < PARALLEL_BYTES ? 1 : aoc_thread_count();
+  if (!(sv.chunks = malloc(*nchunks * sizeof(*sv.chunks)))) abort();
+
+  aoc_trace_begin("summarize");
+  aoc_parallel(*nchunks, summarize, &sv);
+  aoc_trace_end();
 
-    zeros += clicks / 100;
-    clicks %= 100;
+  return sv.chunks;
+}
+
+// Walk the dial through each chunk in turn from `start`, totalling the zeros
+// counted for the position the dial enters each chunk at.
+static uint64_t scan(
+  summary const *chunks,
+  size_t nchunks,
+  int start,
+  int part
+) {
+  uint64_t zeros = 0;
+  size_t i;
 
-    if (dir == 'L') {
-      zeros += (dial > 0 && dial - clicks <= 0);
-      dial -= clicks;
-      if (dial < 0) {
-        dial = 100 + dial;
-      }
+  for (i = 0; i < nchunks; i++) {
+    if (part == 1) {
+      zeros += chunks[i].lands[start];
     } else {
-      dial += clicks;
-      if (dial >= 100) {
-        zeros++;
-        dial -= 100;
-      }
+      zeros += chunks[i].turns + chunks[i].passes[start];
     }
+    start = (start + chunks[i].offset) % 100;
+  }
+
+  return zeros;
+}
+
+uint64_t part1(char const *input) {
+  size_t nchunks;
+  summary *chunks = solve(input, &nchunks);
+  uint64_t zeros = scan(chunks, nchunks, 50, 1);
+
+  free(chunks);
+  return zeros;
+}
+
+uint64_t part2(char const *input) {
+  size_t nchunks;
+  summary *chunks = solve(input, &nchunks);
+  uint64_t zeros = scan(chunks, nchunks, 50, 2);
+
+  free(chunks);
+  return zeros;
+}
+
+// Print the answers to both parts for every position the dial could start in,
+// one "[start]\t[part 1]\t[part 2]" line each. The summaries already cover
+// every start, so this costs a single pass over the input.
+static int sweep(char const *input, int argc, char **argv) {
+  size_t nchunks;
+  summary *chunks;
+  int start;
+
+  if (argc > 0) {
+    fprintf(stderr, "invalid sweep argument '%s'\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  chunks = solve(input, &nchunks);
+
+  aoc_trace_begin("sweep");
+  for (start = 0; start < 100; start++) {
+    printf(
+      "%d\t%" PRIu64 "\t%" PRIu64 "\n",
+      start,
+      scan(chunks, nchunks, start, 1),
+      scan(chunks, nchunks, start, 2)
+    );
+  }
+  aoc_trace_end();
+
+  free(chunks);
+  return EXIT_SUCCESS;
+}
+
+aoc_command const commands[] = {
+  {"sweep", "", sweep},
+  {0},
+};
+
+// The dial only ever needs the current rotation, so the streaming entry points
+// apply each one as soon as its line has been read.
+uint64_t stream1(aoc_stream *stream) {
+  dial d = {50, 0};
+  size_t length;
+  char const *line;
+  int clicks;
+  char dir;
+
+  aoc_trace_begin("rotate");
+  while ((line = aoc_stream_next(stream, '\n', &length))) {
+    if (!next(&line, &dir, &clicks)) continue;
+    rotate1(&d, dir, clicks);
+  }
+  aoc_trace_end();
+
+  return d.zeros;
+}
+
+uint64_t stream2(aoc_stream *stream) {
+  dial d = {50, 0};
+  size_t length;
+  char const *line;
+  int clicks;
+  char dir;
 
-    input += skip;
+  aoc_trace_begin("rotate");
+  while ((line = aoc_stream_next(stream, '\n', &length))) {
+    if (!next(&line, &dir, &clicks)) continue;
+    rotate2(&d, dir, clicks);
   }
+  aoc_trace_end();
 
-  printf("%zu\n", zeros);
+  return d.zeros;
 }
@@ -1,5 +1,4 @@
 #include <assert.h>
-#include <ctype.h>
 #include <inttypes.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -7,44 +6,29 @@
 #include <stdlib.h>
 #include <string.h>
 
-#define BUFLEN (32)
+#include <aoc-array.h>
+#include <aoc-command.h>
+#include <aoc-parse.h>
+#include <aoc-sort.h>
+#include <aoc-time.h>
+#include <aoc-trace.h>
 
 typedef struct Iterator {
   char const *input;
   uint64_t min, max;
 } Iterator;
 
-bool next(Iterator *iter) {
-  char buffer[BUFLEN];
-  size_t length = 0;
-
-  while (isdigit(*iter->input)) {
-    buffer[length++] = *iter->input++;
-    assert(length < BUFLEN);
-  }
-
-  if (length == 0) {
+static bool next(Iterator *iter) {
+  if (!aoc_parse_u64(&iter->input, &iter->min)) {
     return false;
   }
 
-  buffer[length] = '\0';
-  iter->min = strtoul(buffer, NULL, 10);
-
   assert(*iter->input == '-');
   iter->input++;
 
-  length = 0;
-  while (isdigit(*iter->input)) {
-    buffer[length++] = *iter->input++;
-    assert(length < BUFLEN);
-  }
-
-  if (length == 0) {
+  if (!aoc_parse_u64(&iter->input, &iter->max)) {
     return false;
   }
-
-  buffer[length] = '\0';
-  iter->max = strtoul(buffer, NULL, 10);
   assert(iter->min < iter->max);
 
   if (*iter->input == ',') {
@@ -54,180 +38,296 @@ bool next(Iterator *iter) {
   return true;
 }
 
-typedef struct Node {
-  uint64_t value;
-  struct Node *left;
-  struct Node *right;
-} Node;
+typedef unsigned __int128 u128;
 
-Node *tree = NULL;
+typedef struct range {
+  uint64_t min;
+  uint64_t max;
+} range;
 
-bool insert(Node **tree, uint64_t value) {
-  Node *parent = NULL;
-  Node **slot = tree;
+AOC_ARRAY_STATIC(range_list, range)
 
-  while (*slot) {
-    parent = *slot;
-    if (value == parent->value) {
-      return false;
-    } else if (value < parent->value) {
-      slot = &parent->left;
-    } else {
-      slot = &parent->right;
-    }
-  }
-
-  *slot = malloc(sizeof(Node));
-  **slot = (Node){value};
-
-  return true;
+static uint64_t range_key(void const *item) {
+  return ((range const *)item)->min;
 }
 
-void delete(Node **tree) {
-  if (!tree || !*tree) {
-    return;
+// Parse every range, then merge any that overlap so that no id is counted
+// twice. Returns the merged ranges sorted by their minimum.
+static range_list range_list_new(char const *input) {
+  Iterator iter = {input};
+  range_list list = {0};
+  range *r, *merged;
+
+  aoc_trace_begin("parse");
+  while (next(&iter)) {
+    range_list_push(&list, (range){iter.min, iter.max});
+  }
+  aoc_trace_end();
+
+  if (list.count == 0) return list;
+
+  aoc_trace_begin("merge");
+  aoc_sort(
+    list.items,
+    list.count,
+    sizeof(*list.items),
+    range_key,
+    AOC_SORT_ASCENDING
+  );
+
+  merged = list.items;
+  for (r = list.items + 1; r < list.items + list.count; r++) {
+    if (r->min <= merged->max) {
+      if (r->max > merged->max) merged->max = r->max;
+    } else {
+      *++merged = *r;
+    }
   }
+  list.count = merged - list.items + 1;
+  aoc_trace_end();
 
-  delete (&(*tree)->left);
-  delete (&(*tree)->right);
-  free(*tree);
-  *tree = NULL;
+  return list;
 }
 
 // Return the number of digits in `val`.
-uint64_t length10(uint64_t val) {
-  uint64_t len = 0;
+static unsigned length10(uint64_t val) {
+  unsigned len = 0;
   while (val != 0) {
     val /= 10;
     len += 1;
   }
+
   return len;
 }
 
 // Return 10 to the `exp` power.
-uint64_t power10(uint64_t exp) {
-  uint64_t val = 1;
+static u128 power10(unsigned exp) {
+  u128 val = 1;
   for (; exp != 0; exp--) {
     val *= 10;
   }
+
   return val;
 }
 
-// Shift `val` right by `shift` decimal digits.
-uint64_t rshift10(uint64_t val, uint64_t shift) {
-  for (uint64_t i = 0; i < shift; i++) {
-    val /= 10;
-  }
-  return val;
+// Sum the `len`-digit numbers in [lo, hi] that are a `period`-digit unit
+// repeated len / period times.
+//
+// Every such number is the unit times a multiplier like 10101 (for a two-digit
+// unit repeated three times), so this is the multiplier times the sum of an
+// arithmetic series of units. The units run from '1[zeros]' to '[nines]',
+// narrowed down to those whose repetition lands inside [lo, hi].
+static u128 periodic_sum(u128 lo, u128 hi, unsigned len, unsigned period) {
+  u128 mult = (power10(len) - 1) / (power10(period) - 1);
+  u128 first = power10(period - 1);
+  u128 last = power10(period) - 1;
+
+  if (first < (lo + mult - 1) / mult) first = (lo + mult - 1) / mult;
+  if (last > hi / mult) last = hi / mult;
+  if (first > last) return 0;
+
+  return mult * ((first + last) * (last - first + 1) / 2);
 }
 
-// Repeat the digits of `rep` `count` times.
-uint64_t repeat(uint64_t rep, uint64_t count) {
-  uint64_t power = 1;
-  while (power <= rep) {
-    power *= 10;
+// Sum the `len`-digit numbers in [lo, hi] made of any shorter unit repeated at
+// least twice.
+//
+// A number repeats some shorter unit exactly when it repeats a unit of
+// len / p digits for a prime p dividing len. A number that does so for two
+// primes p and q also repeats a unit of len / (p * q) digits. For example,
+// '222222' is three '22's, two '222's and six '2's. So the sum follows by
+// inclusion-exclusion over the prime factors of len, which never has more
+// than two below 30.
+static u128 repeated_sum(u128 lo, u128 hi, unsigned len) {
+  unsigned primes[4], nprimes = 0;
+  unsigned p, rest, mask, i, divisor, bits;
+  u128 total = 0;
+
+  for (p = 2, rest = len; rest > 1; p++) {
+    if (rest % p != 0) continue;
+    primes[nprimes++] = p;
+    while (rest % p == 0) rest /= p;
   }
 
-  uint64_t total = rep;
-  for (uint64_t i = 1; i < count; i++) {
-    total *= power;
-    total += rep;
+  for (mask = 1; mask < (1u << nprimes); mask++) {
+    divisor = 1;
+    bits = 0;
+    for (i = 0; i < nprimes; i++) {
+      if (!(mask & (1u << i))) continue;
+      divisor *= primes[i];
+      bits++;
+    }
+
+    if (bits % 2 == 1) {
+      total += periodic_sum(lo, hi, len, len / divisor);
+    } else {
+      total -= periodic_sum(lo, hi, len, len / divisor);
+    }
   }
+
   return total;
 }
 
-// Calculate the sum of all numbers that can be broken into `parts` segments
-// of repeating digits in the (inclusive) range from `min` to `max`.
-uint64_t range(uint64_t min, uint64_t max, size_t parts) {
-  uint64_t minrep, maxrep;
-  uint64_t i, j, value;
-  uint64_t total = 0;
-  uint64_t replen, shift;
-
-  uint64_t minlen = length10(min);
-  uint64_t maxlen = length10(max);
-
-  if (minlen % parts == 0) {
-    // Get the length of the repetition. For example, '123456' divided into
-    // three `parts` has a repetition length of two.
-    replen = minlen / parts;
-
-    // We need to extract the `replen` most significant digits from minlen to
-    // get our unit of repetition. In our earlier example, this is '12'.
-    shift = minlen - replen;
-    minrep = rshift10(min, shift);
-
-    // We _might_ need to adjust the unit. If we actually repeated '12' three
-    // times, we would get '121212'. This is less than our minimum, so we need
-    // to bump it up to '13' and '131313'.
-    if (repeat(minrep, parts) < min) {
-      minrep++;
-    }
-  } else {
-    // If the minlen doesn't divide nicely into the number of parts we're
-    // looking for (e.g. '12345' cannot be split into three parts) then our unit
-    // of repetion is '1[zeros]' where '[zeros]' is floor(len / parts). In our
-    // example, the unit is '10' for a complete number of '101010'.
-    minrep = power10(minlen / parts);
+// Sum the invalid `len`-digit ids in [lo, hi]: those made of a unit repeated
+// exactly twice, or with `any` set, repeated any number of times.
+static u128 length_sum(u128 lo, u128 hi, unsigned len, bool any) {
+  if (any) return repeated_sum(lo, hi, len);
+  if (len % 2 == 0) return periodic_sum(lo, hi, len, len / 2);
+  return 0;
+}
+
+// Sum the invalid ids in `r`. Each length of number in the range is handled
+// separately, so this takes O(digits²) arithmetic however wide the range is.
+static u128 range_sum(range r, bool any) {
+  unsigned len = length10(r.min);
+  unsigned maxlen = length10(r.max);
+  u128 lo, hi, total = 0;
+
+  for (len = len ? len : 1; len <= maxlen; len++) {
+    lo = power10(len - 1) > r.min ? power10(len - 1) : r.min;
+    hi = power10(len) - 1 < r.max ? power10(len) - 1 : r.max;
+    total += length_sum(lo, hi, len, any);
   }
 
-  if (maxlen % parts == 0) {
-    // This part works the same as the minimum length.
-    replen = maxlen / parts;
-    shift = maxlen - replen;
-    maxrep = rshift10(max, shift);
+  return total;
+}
+
+// Sums wrap at 64 bits, like adding up every id one at a time would.
+static uint64_t solve(char const *input, bool any) {
+  range_list ranges = range_list_new(input);
+  u128 total = 0;
+  size_t i;
 
-    // However, instead of undershooting the minimum, we need to make sure we
-    // aren't overshooting our maximum.
-    if (repeat(maxrep, parts) > max) {
-      maxrep--;
-    }
-  } else {
-    // We also need to drop down to '[nines]' instead of up to '1[zeros]' to
-    // find the unit. For example, if our max is '12345' and we need three
-    // parts, then our unit is '9' and the complete number is '999'.
-    maxrep = power10(maxlen / parts) - 1;
+  aoc_trace_begin("ranges");
+  for (i = 0; i < ranges.count; i++) {
+    total += range_sum(ranges.items[i], any);
   }
+  aoc_trace_end();
 
-  // Then we step through each possible unit of repetition, repeat it the
-  // correct number of times, and add it to the total.
-  //
-  // An important caveat is that we cannot repeat numbers. So '222222', which is
-  // either two '222's, three '22's, or six '2's, must only be counted once.
-  for (i = minrep; i <= maxrep; i++) {
-    value = repeat(i, parts);
-    if (insert(&tree, value)) {
-      total += value;
-    }
+  range_list_free(&ranges);
+  return (uint64_t)total;
+}
+
+// Digits in the largest id that fits in 64 bits.
+#define MAXLEN 20
+
+// Queries are read, answered and printed this many at a time.
+#define QUERY_BATCH 4096
+
+// The sums of the invalid ids of each length, accumulated so that below[len]
+// is the sum of all those with fewer than `len` digits. The sum up to any id
+// then only needs the partial sum over its own length.
+typedef struct id_index {
+  bool any;
+  u128 below[MAXLEN + 2];
+} id_index;
+
+static void id_index_build(id_index *index, bool any) {
+  unsigned len;
+  u128 lo, hi;
+
+  index->any = any;
+  index->below[1] = 0;
+  for (len = 1; len <= MAXLEN; len++) {
+    lo = power10(len - 1);
+    hi = power10(len) - 1;
+    index->below[len + 1] = index->below[len] + length_sum(lo, hi, len, any);
   }
+}
 
-  return total;
+// Return the sum of the invalid ids in [1, id].
+static u128 id_index_upto(id_index const *index, uint64_t id) {
+  unsigned len = length10(id);
+
+  if (len == 0) return 0;
+  return index->below[len] +
+         length_sum(power10(len - 1), id, len, index->any);
 }
 
-void part1(char const *input) {
-  Iterator iter = {input};
-  uint64_t total = 0;
+// Answer one query as a difference of two sums from the index.
+static uint64_t id_index_query(id_index const *index, range r) {
+  u128 total = id_index_upto(index, r.max);
+  if (r.min > 0) total -= id_index_upto(index, r.min - 1);
+  return (uint64_t)total;
+}
 
-  while (next(&iter)) {
-    total += range(iter.min, iter.max, 2);
+// Parse the next "min-max" query. Queries may be separated by commas or line
+// breaks.
+static bool next_query(char const **input, range *r) {
+  aoc_parse_space(input);
+  aoc_parse_char(input, ',');
+  aoc_parse_space(input);
+
+  if (!aoc_parse_u64(input, &r->min)) return false;
+  if (!aoc_parse_char(input, '-')) return false;
+  if (!aoc_parse_u64(input, &r->max)) return false;
+  return r->min <= r->max;
+}
+
+// Treat the input as a list of id ranges and print the sum of the invalid ids
+// in each, one per line. Unlike the puzzle, every query is answered on its own,
+// even if it overlaps others.
+static int index_queries(char const *input, int argc, char **argv) {
+  range queries[QUERY_BATCH];
+  uint64_t answers[QUERY_BATCH];
+  uint64_t start, elapsed = 0, total = 0;
+  size_t i, count;
+  id_index index;
+
+  if (argc != 1 || (argv[0][0] != '1' && argv[0][0] != '2')) {
+    fprintf(stderr, "index needs a part, either '1' or '2'\n");
+    return EXIT_FAILURE;
   }
 
-  printf("%" PRIu64 "\n", total);
-  delete (&tree);
-}
+  aoc_trace_begin("build");
+  id_index_build(&index, argv[0][0] == '2');
+  aoc_trace_end();
 
-void part2(char const *input) {
-  Iterator iter = {input};
-  uint64_t maxlen, parts;
-  uint64_t total = 0;
+  do {
+    for (count = 0; count < QUERY_BATCH; count++) {
+      if (!next_query(&input, &queries[count])) break;
+    }
 
-  while (next(&iter)) {
-    maxlen = length10(iter.max);
-    for (parts = 2; parts <= maxlen; parts++) {
-      total += range(iter.min, iter.max, parts);
+    aoc_trace_begin("queries");
+    start = aoc_time_ns();
+    for (i = 0; i < count; i++) {
+      answers[i] = id_index_query(&index, queries[i]);
+    }
+    elapsed += aoc_time_ns() - start;
+    aoc_trace_end();
+
+    for (i = 0; i < count; i++) {
+      printf("%" PRIu64 "\n", answers[i]);
     }
+    total += count;
+  } while (count == QUERY_BATCH);
+
+  aoc_parse_space(&input);
+  if (*input != '\0') {
+    fprintf(stderr, "invalid query after %" PRIu64 " queries\n", total);
+    return EXIT_FAILURE;
   }
 
-  printf("%" PRIu64 "\n", total);
-  delete (&tree);
+  fprintf(
+    stderr,
+    "%" PRIu64 " queries in %.3f ms (%.1f queries/s)\n",
+    total,
+    aoc_time_ms(elapsed),
+    elapsed ? (double)total / ((double)elapsed / 1e9) : 0.0
+  );
+
+  return EXIT_SUCCESS;
+}
+
+aoc_command const commands[] = {
+  {"index", "[part]", index_queries},
+  {0},
+};
+
+uint64_t part1(char const *input) {
+  return solve(input, false);
+}
+
+uint64_t part2(char const *input) {
+  return solve(input, true);
 }
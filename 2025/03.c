@@ -4,6 +4,25 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <aoc-command.h>
+#include <aoc-mapreduce.h>
+#include <aoc-parse.h>
+#include <aoc-stream.h>
+#include <aoc-time.h>
+#include <aoc-trace.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// The most digits maxvalue can pick; the select command has no limit.
+#define MAXDIGITS (20)
 
 typedef struct Iterator {
   char const *input;
@@ -11,11 +30,9 @@ typedef struct Iterator {
   size_t length;
 } Iterator;
 
-bool next(Iterator *iter) {
+static bool next(Iterator *iter) {
   iter->line = iter->input;
-  while (isdigit(*iter->input)) {
-    iter->input++;
-  }
+  iter->input += aoc_parse_digits(iter->input);
 
   if (iter->line == iter->input) {
     return false;
@@ -30,64 +47,190 @@ bool next(Iterator *iter) {
   return true;
 }
 
-// Scan the input line for the first occurence of the highest digit in the
-// provided range. Return the index of the digit.
-size_t maxchar(char const *line, size_t minidx, size_t maxidx) {
-  size_t i, maxpos = minidx;
-  char maxval = line[minidx];
-
-  for (i = minidx; i < maxidx; i++) {
-    if (line[i] > maxval) {
-      maxval = line[i];
-      maxpos = i;
-    }
+// Return the index of the first digit in line[from, length) above `digit`,
+// or `length` if there is none. Digits are compared 32 or 16 at a time where
+// the line is long enough.
+static size_t find_above(
+  char const *line,
+  size_t from,
+  size_t length,
+  char digit
+) {
+  unsigned bits;
+
+#ifdef __AVX2__
+  __m256i limit32 = _mm256_set1_epi8(digit);
+  for (; from + 32 <= length; from += 32) {
+    __m256i block = _mm256_loadu_si256((__m256i const *)(line + from));
+    bits = (unsigned)_mm256_movemask_epi8(_mm256_cmpgt_epi8(block, limit32));
+    if (bits) return from + (size_t)__builtin_ctz(bits);
+  }
+#endif
+
+#ifdef __SSE2__
+  __m128i limit16 = _mm_set1_epi8(digit);
+  for (; from + 16 <= length; from += 16) {
+    __m128i block = _mm_loadu_si128((__m128i const *)(line + from));
+    bits = (unsigned)_mm_movemask_epi8(_mm_cmpgt_epi8(block, limit16));
+    if (bits) return from + (size_t)__builtin_ctz(bits);
   }
+#endif
 
-  return maxpos;
+  (void)bits;
+  for (; from < length && line[from] <= digit; from++) {}
+  return from;
 }
 
-// Find the highest possible number with `count` digits in the line.
-uint64_t maxvalue(char const *line, size_t length, size_t count) {
-  uint64_t value = 0;
-  size_t i, pos = 0;
+// Write the `count` digits of the line that, kept in order, form the highest
+// possible number to `digits`.
+//
+// This is a single greedy pass with a stack. Each digit pops the smaller
+// digits before it, as long as enough of the line remains to fill the stack
+// back up, and is then pushed if there is room. Once the stack is full, a
+// digit can only change it if it is above the last one kept, so the scan skips
+// straight to the next such digit.
+static void select_digits(
+  char const *line,
+  size_t length,
+  size_t count,
+  char *digits
+) {
+  size_t i, top = 0;
+  char c;
 
   assert(length >= count);
+  if (count == 0) return;
 
-  for (i = 1; i <= count; i++) {
-    // Find the highest digit in the line, but exclude enough of the end to
-    // ensure that we have enough digits left to finish the value.
-    pos = maxchar(line, pos, length - count + i);
-
-    // Add the digit to the final value.
-    value *= 10;
-    value += line[pos] - '0';
+  for (i = 0; i < length; i++) {
+    if (top == count) {
+      i = find_above(line, i, length, digits[top - 1]);
+      if (i == length) break;
+    }
 
-    // Step past the digit we just found to ensure that it isn't included
-    // multiple times.
-    pos++;
+    c = line[i];
+    while (top > 0 && digits[top - 1] < c && top - 1 + length - i >= count) {
+      top--;
+    }
+    if (top < count) digits[top++] = c;
   }
+}
+
+// Find the highest possible number with `count` digits in the line. Numbers
+// with more than 19 digits wrap.
+static uint64_t maxvalue(char const *line, size_t length, size_t count) {
+  char digits[MAXDIGITS];
 
-  return value;
+  assert(count <= MAXDIGITS);
+
+  select_digits(line, length, count, digits);
+  return aoc_parse_convert(digits, count);
 }
 
-void part1(char const *input) {
+// Print the highest `k`-digit selection from every line, as digits, so that k
+// may be as long as the lines themselves. Lines shorter than k print '-'.
+static int select_k(char const *input, int argc, char **argv) {
   Iterator iter = {input};
-  uint64_t total = 0;
+  size_t count, size, lines = 0;
+  uint64_t start;
+  char *digits;
+
+  if (argc != 1 || !aoc_parse_count(argv[0], &count)) {
+    fprintf(stderr, "select needs a digit count\n");
+    return EXIT_FAILURE;
+  }
+
+  // No line can be longer than the input, so neither can a selection.
+  size = strlen(input);
+  if (count < size) size = count;
+  if (!(digits = malloc(size + 1))) abort();
 
+  start = aoc_time_ns();
+  aoc_trace_begin("lines");
   while (next(&iter)) {
-    total += maxvalue(iter.line, iter.length, 2);
+    lines++;
+    if (iter.length < count) {
+      printf("-\n");
+      continue;
+    }
+
+    select_digits(iter.line, iter.length, count, digits);
+    digits[count] = '\0';
+    printf("%s\n", digits);
   }
+  aoc_trace_end();
+
+  fprintf(
+    stderr,
+    "selected %zu digits from %zu lines in %.3f ms\n",
+    count,
+    lines,
+    aoc_time_ms(aoc_time_ns() - start)
+  );
+
+  free(digits);
+  return EXIT_SUCCESS;
+}
+
+aoc_command const commands[] = {
+  {"select", "[k]", select_k},
+  {0},
+};
 
-  printf("%" PRIu64 "\n", total);
+// Map one line to its highest `*ctx`-digit number.
+static bool map_line(void *ctx, char const **input, uint64_t *value) {
+  Iterator iter = {*input};
+
+  if (!next(&iter)) return false;
+  *value = maxvalue(iter.line, iter.length, *(size_t const *)ctx);
+  *input = iter.input;
+  return true;
 }
 
-void part2(char const *input) {
-  Iterator iter = {input};
+// Banks are independent, so lines are solved in parallel and summed.
+static uint64_t solve(char const *input, size_t count) {
+  aoc_mapreduce mr = {.map = map_line, .ctx = &count};
+  uint64_t total;
+
+  aoc_trace_begin("lines");
+  total = aoc_mapreduce_run(&mr, input, strlen(input));
+  aoc_trace_end();
+
+  return total;
+}
+
+uint64_t part1(char const *input) {
+  return solve(input, 2);
+}
+
+uint64_t part2(char const *input) {
+  return solve(input, 12);
+}
+
+// Every bank is independent, so the streaming entry points only ever hold the
+// current line.
+static uint64_t stream_lines(aoc_stream *stream, size_t count) {
   uint64_t total = 0;
+  size_t length;
+  char *line;
 
-  while (next(&iter)) {
-    total += maxvalue(iter.line, iter.length, 12);
+  aoc_trace_begin("lines");
+  while ((line = aoc_stream_next(stream, '\n', &length))) {
+    while (length > 0 && isspace(line[length - 1])) {
+      length--;
+    }
+    if (length == 0) continue;
+
+    total += maxvalue(line, length, count);
   }
+  aoc_trace_end();
+
+  return total;
+}
+
+uint64_t stream1(aoc_stream *stream) {
+  return stream_lines(stream, 2);
+}
 
-  printf("%" PRIu64 "\n", total);
+uint64_t stream2(aoc_stream *stream) {
+  return stream_lines(stream, 12);
 }
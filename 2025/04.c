@@ -1,4 +1,3 @@
-#include <ctype.h>
 #include <inttypes.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -6,96 +5,339 @@
 #include <stdlib.h>
 #include <string.h>
 
-typedef struct Grid {
-  char *data;
-  size_t width;
-  size_t height;
-  size_t stride;
-} Grid;
+#include <aoc-array.h>
+#include <aoc-command.h>
+#include <aoc-grid.h>
+#include <aoc-thread.h>
+#include <aoc-time.h>
+#include <aoc-trace.h>
 
-Grid measure(char *input) {
-  Grid grid = {input};
+// Grids with fewer cells than this are scanned as a single band.
+#define PARALLEL_CELLS (1024 * 1024)
 
-  for (; !isspace(*input); input++) {
-    grid.width++;
-    grid.stride++;
-  }
+// Add three one-bit numbers in every bit position at once, giving the sum and
+// carry bits.
+static void full_add(
+  uint64_t a,
+  uint64_t b,
+  uint64_t c,
+  uint64_t *sum,
+  uint64_t *carry
+) {
+  uint64_t half = a ^ b;
+  *sum = half ^ c;
+  *carry = (a & b) | (half & c);
+}
 
-  for (; isspace(*input); input++) {
-    grid.stride++;
-  }
+// Return the rolls in the word at `row` that have fewer than four rolls around
+// them, 64 cells at a time, given the same word of the rows above and below.
+//
+// The eight neighbours of every cell are the rows above, at and below it,
+// shifted a cell left and right with the bits carried over from the adjacent
+// words, so every row needs a zero word on either side. The zero words and
+// rows around the grid stand in for the border.
+// Neighbours are then counted with bit-sliced adders: first to a ones bit and
+// four twos bits, and then the count reaches four exactly when at least two of
+// the twos bits are set.
+static uint64_t accessible(
+  uint64_t const *above,
+  uint64_t const *row,
+  uint64_t const *below
+) {
+  uint64_t s0, s1, s2, ones, c0, c1, c2, c3, twos, fours;
 
-  grid.height = 1;
-  for (; *input != 0; input++) {
-    grid.height += *input == '\n';
-  }
+  full_add(
+    above[0],
+    (above[0] << 1) | (above[-1] >> 63),
+    (above[0] >> 1) | (above[1] << 63),
+    &s0,
+    &c0
+  );
+  full_add(
+    below[0],
+    (below[0] << 1) | (below[-1] >> 63),
+    (below[0] >> 1) | (below[1] << 63),
+    &s1,
+    &c1
+  );
+  full_add(
+    (row[0] << 1) | (row[-1] >> 63),
+    (row[0] >> 1) | (row[1] << 63),
+    0,
+    &s2,
+    &c2
+  );
+  full_add(s0, s1, s2, &ones, &c3);
+  full_add(c0, c1, c2, &twos, &fours);
+  (void)ones;
 
-  return grid;
+  return row[0] & ~(fours | (twos & c3));
 }
 
-char get(Grid *grid, size_t x, size_t y) {
-  if (x >= grid->width || y >= grid->height) {
-    return '\0';
-  }
+// The grid is split into one band of rows per thread, and only the bit rows are
+// kept, so even a grid too large for a second copy can be solved in place.
+//
+// Rounds update a band's rows in place, keeping a copy of the previous row so
+// that the row below still sees the old one. Rows on the edge of a band are
+// read by the neighbouring bands too, so every round starts with each band
+// publishing the old copies of its first and last rows as halos, and the
+// neighbours read those instead of the grid.
+typedef struct stencil {
+  aoc_grid_bits rolls;
+  size_t nbands;
+  // Four rows per band: the first and last row halos, and two scratch rows.
+  // Each has a zero word before it, and ends with the row's zero word.
+  uint64_t *rows;
+  uint64_t *removed;
+  aoc_barrier barrier;
+} stencil;
+
+static void stencil_load(stencil *self, char const *input) {
+  size_t cells;
+
+  memset(self, 0, sizeof(*self));
+
+  aoc_trace_begin("pack");
+  aoc_grid_bits_load(&self->rolls, input, '@');
+  aoc_trace_end();
 
-  return grid->data[x + y * grid->stride];
+  cells = self->rolls.width * self->rolls.height;
+  self->nbands = cells < PARALLEL_CELLS ? 1 : aoc_thread_count();
+  if (self->nbands > self->rolls.height) self->nbands = self->rolls.height;
+
+  self->rows = calloc(
+    self->nbands * 4 * (self->rolls.stride + 1),
+    sizeof(*self->rows)
+  );
+  self->removed = calloc(self->nbands, sizeof(*self->removed));
+  if (!self->rows || !self->removed) abort();
+  aoc_barrier_init(&self->barrier, self->nbands ? self->nbands : 1);
 }
 
-bool accessible(Grid *grid, size_t x, size_t y) {
-  if (get(grid, x, y) != '@') {
-    return false;
-  }
+static void stencil_free(stencil *self) {
+  aoc_barrier_destroy(&self->barrier);
+  aoc_grid_bits_free(&self->rolls);
+  free(self->removed);
+  free(self->rows);
+}
 
-  size_t nearby = 0;
-  nearby += ('@' == get(grid, x - 1, y - 1));
-  nearby += ('@' == get(grid, x - 1, y));
-  nearby += ('@' == get(grid, x - 1, y + 1));
-  nearby += ('@' == get(grid, x + 1, y - 1));
-  nearby += ('@' == get(grid, x + 1, y));
-  nearby += ('@' == get(grid, x + 1, y + 1));
-  nearby += ('@' == get(grid, x, y - 1));
-  nearby += ('@' == get(grid, x, y + 1));
-  return nearby < 4;
+// Return row `k` of the four belonging to `band`.
+static uint64_t *stencil_row(stencil const *self, size_t band, size_t k) {
+  return self->rows + (band * 4 + k) * (self->rolls.stride + 1) + 1;
 }
 
-void part1(char const *input) {
-  Grid grid = measure(strdup(input));
+// Find the rows [first, last) of `band`. Bands are never empty, since there
+// are at most as many bands as rows.
+static void stencil_band(
+  stencil const *self,
+  size_t band,
+  size_t *first,
+  size_t *last
+) {
+  *first = self->rolls.height * band / self->nbands;
+  *last = self->rolls.height * (band + 1) / self->nbands;
+}
+
+static void scan(void *ctx, size_t id, size_t count) {
+  stencil *s = ctx;
+  aoc_grid_bits const *rolls = &s->rolls;
+  uint64_t const *above, *row, *below;
   uint64_t total = 0;
-  size_t x, y;
+  size_t first, last, y, i;
 
-  for (y = 0; y < grid.height; y++) {
-    for (x = 0; x < grid.width; x++) {
-      total += accessible(&grid, x, y);
+  (void)count;
+
+  stencil_band(s, id, &first, &last);
+  for (y = first; y < last; y++) {
+    above = aoc_grid_bits_row(rolls, y - 1);
+    row = aoc_grid_bits_row(rolls, y);
+    below = aoc_grid_bits_row(rolls, y + 1);
+    for (i = 0; i + 1 < rolls->stride; i++) {
+      total += __builtin_popcountll(accessible(above + i, row + i, below + i));
     }
   }
 
-  printf("%" PRIu64 "\n", total);
-  free(grid.data);
+  s->removed[id] = total;
 }
 
-void part2(char const *input) {
-  Grid active, source;
-  uint64_t removed, total = 0;
-  size_t x, y;
+static void peel(void *ctx, size_t id, size_t count) {
+  stencil *s = ctx;
+  aoc_grid_bits *rolls = &s->rolls;
+  size_t bytes = rolls->stride * sizeof(uint64_t);
+  uint64_t *top = stencil_row(s, id, 0), *bottom = stencil_row(s, id, 1);
+  uint64_t *old = stencil_row(s, id, 2), *older = stencil_row(s, id, 3);
+  uint64_t const *above, *below;
+  uint64_t *row, *swap, removed, mask, total = 0;
+  size_t first, last, y, i, band;
 
-  active = measure(strdup(input));
-  source = measure(strdup(input));
+  stencil_band(s, id, &first, &last);
 
   do {
+    memcpy(top, aoc_grid_bits_row(rolls, first), bytes);
+    memcpy(bottom, aoc_grid_bits_row(rolls, last - 1), bytes);
+    aoc_barrier_wait(&s->barrier);
+
     removed = 0;
-    for (y = 0; y < source.height; y++) {
-      for (x = 0; x < source.width; x++) {
-        if (accessible(&source, x, y)) {
-          active.data[x + y * active.stride] = '.';
-          removed++;
-        }
+    above = id > 0 ? stencil_row(s, id - 1, 1) : aoc_grid_bits_row(rolls, -1);
+    for (y = first; y < last; y++) {
+      row = aoc_grid_bits_row(rolls, y);
+      memcpy(old, row, bytes);
+
+      if (y + 1 < last) {
+        below = aoc_grid_bits_row(rolls, y + 1);
+      } else if (id + 1 < count) {
+        below = stencil_row(s, id + 1, 0);
+      } else {
+        below = aoc_grid_bits_row(rolls, y + 1);
+      }
+
+      for (i = 0; i + 1 < rolls->stride; i++) {
+        mask = accessible(above + i, old + i, below + i);
+        row[i] = old[i] & ~mask;
+        removed += __builtin_popcountll(mask);
       }
+
+      above = old;
+      swap = old;
+      old = older;
+      older = swap;
     }
+
+    // Every band adds up the same counts, so they all agree on when to stop.
     total += removed;
-    strcpy(source.data, active.data);
+    s->removed[id] = removed;
+    aoc_barrier_wait(&s->barrier);
+    for (removed = 0, band = 0; band < count; band++) {
+      removed += s->removed[band];
+    }
   } while (removed != 0);
 
-  printf("%" PRIu64 "\n", total);
-  free(active.data);
-  free(source.data);
+  // Wait for the last round's counts to be read before reusing them.
+  aoc_barrier_wait(&s->barrier);
+  s->removed[id] = total;
+}
+
+static uint64_t solve(char const *input, aoc_thread_fn fn) {
+  stencil s;
+  uint64_t total = 0;
+  size_t band;
+
+  stencil_load(&s, input);
+
+  aoc_trace_begin("stencil");
+  if (s.nbands > 0) aoc_parallel(s.nbands, fn, &s);
+  aoc_trace_end();
+
+  for (band = 0; band < s.nbands; band++) {
+    total += s.removed[band];
+  }
+
+  stencil_free(&s);
+  return total;
+}
+
+// Peel the rolls away round by round, like a k-core, printing how many fall in
+// each round as "[round]\t[removed]".
+//
+// Instead of rescanning the grid every round, this keeps the number of rolls
+// around every roll and a worklist of the rolls that fall this round. Removing
+// a roll only updates its neighbours, and a neighbour whose count drops below
+// four joins the next round's worklist, so the whole run costs O(cells). The
+// counts a round sees are only updated by earlier rounds, so the rounds match
+// the ones in part 2.
+static int rounds(char const *input, int argc, char **argv) {
+  aoc_grid grid;
+  aoc_array current = {0}, next = {0}, swap;
+  uint8_t *nearby;
+  uint64_t cell, neighbour, total = 0, round, start;
+  ptrdiff_t offsets[8];
+  size_t x, y, i, k;
+  char *row;
+
+  (void)argv;
+  if (argc > 0) {
+    fprintf(stderr, "rounds takes no arguments\n");
+    return EXIT_FAILURE;
+  }
+
+  start = aoc_time_ns();
+  aoc_grid_load(&grid, input, 1, '.');
+  if (!(nearby = calloc(grid.size, sizeof(*nearby)))) abort();
+
+  offsets[0] = -(ptrdiff_t)grid.stride - 1;
+  offsets[1] = -(ptrdiff_t)grid.stride;
+  offsets[2] = -(ptrdiff_t)grid.stride + 1;
+  offsets[3] = -1;
+  offsets[4] = 1;
+  offsets[5] = (ptrdiff_t)grid.stride - 1;
+  offsets[6] = (ptrdiff_t)grid.stride;
+  offsets[7] = (ptrdiff_t)grid.stride + 1;
+
+  aoc_trace_begin("count");
+  for (y = 0; y < grid.height; y++) {
+    row = aoc_grid_row(&grid, y);
+    for (x = 0; x < grid.width; x++) {
+      if (row[x] != '@') continue;
+
+      cell = row + x - grid.storage;
+      for (k = 0; k < 8; k++) {
+        nearby[cell] += grid.storage[cell + offsets[k]] == '@';
+      }
+      if (nearby[cell] < 4) aoc_array_push(&current, cell);
+    }
+  }
+  aoc_trace_end();
+
+  for (round = 1; current.count > 0; round++) {
+    aoc_trace_begin("round");
+    for (i = 0; i < current.count; i++) {
+      grid.storage[current.items[i]] = '.';
+    }
+
+    for (i = 0; i < current.count; i++) {
+      cell = current.items[i];
+      for (k = 0; k < 8; k++) {
+        neighbour = cell + offsets[k];
+        if (grid.storage[neighbour] != '@') continue;
+        if (nearby[neighbour]-- == 4) aoc_array_push(&next, neighbour);
+      }
+    }
+    aoc_trace_end();
+
+    printf("%" PRIu64 "\t%zu\n", round, current.count);
+    total += current.count;
+
+    swap = current;
+    current = next;
+    next = swap;
+    next.count = 0;
+  }
+
+  fprintf(
+    stderr,
+    "removed %" PRIu64 " rolls in %" PRIu64 " rounds in %.3f ms\n",
+    total,
+    round - 1,
+    aoc_time_ms(aoc_time_ns() - start)
+  );
+
+  aoc_array_free(&current);
+  aoc_array_free(&next);
+  free(nearby);
+  aoc_grid_free(&grid);
+  return EXIT_SUCCESS;
+}
+
+aoc_command const commands[] = {
+  {"rounds", "", rounds},
+  {0},
+};
+
+uint64_t part1(char const *input) {
+  return solve(input, scan);
+}
+
+// Every round removes all the accessible rolls at once.
+uint64_t part2(char const *input) {
+  return solve(input, peel);
 }
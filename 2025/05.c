@@ -5,14 +5,12 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-uint64_t min64(uint64_t a, uint64_t b) {
-  return a < b ? a : b;
-}
-
-uint64_t max64(uint64_t a, uint64_t b) {
-  return a > b ? a : b;
-}
+#include <aoc-arena.h>
+#include <aoc-mapreduce.h>
+#include <aoc-parse.h>
+#include <aoc-trace.h>
 
 typedef struct _iterator {
   char const *input;
@@ -20,28 +18,12 @@ typedef struct _iterator {
   uint64_t max;
 } iterator;
 
-bool readint(char const **input, uint64_t *value) {
-  char buffer[50];
-  size_t length = 0;
-
-  while (isdigit(**input)) {
-    buffer[length++] = *((*input)++);
-    assert(length < sizeof(buffer));
-  }
-
-  if (length == 0) return false;
-
-  buffer[length] = '\0';
-  *value = strtoul(buffer, NULL, 10);
-  return true;
-}
-
-bool next_range(iterator *it) {
+static bool next_range(iterator *it) {
   char const *input = it->input;
 
-  if (!readint(&input, &it->min)) goto fail;
+  if (!aoc_parse_u64(&input, &it->min)) goto fail;
   if (*input++ != '-') goto fail;
-  if (!readint(&input, &it->max)) goto fail;
+  if (!aoc_parse_u64(&input, &it->max)) goto fail;
   while (isspace(*input))
     input++;
 
@@ -52,10 +34,10 @@ fail:
   return false;
 }
 
-bool next_value(iterator *it) {
+static bool next_value(iterator *it) {
   char const *input = it->input;
 
-  if (!readint(&input, &it->min)) goto fail;
+  if (!aoc_parse_u64(&input, &it->min)) goto fail;
   while (isspace(*input))
     input++;
 
@@ -74,24 +56,22 @@ typedef struct range_tree_node {
   struct range_tree_node *right;
 } range_tree_node;
 
+// Nodes live in `arena`. Nodes dropped when ranges merge are simply left
+// there until the whole tree is freed.
 typedef struct range_tree {
   range_tree_node *root;
+  aoc_arena arena;
 } range_tree;
 
-void range_tree_node_free(range_tree_node *node) {
-  if (!node) return;
-  range_tree_node_free(node->left);
-  range_tree_node_free(node->right);
-  free(node);
-}
-
-void range_tree_free(range_tree *tree) {
-  range_tree_node_free(tree->root);
+static void range_tree_free(range_tree *tree) {
+  aoc_arena_free(&tree->arena);
   tree->root = NULL;
 }
 
-range_tree_node *range_tree_node_delete_ge(range_tree_node *node, uint64_t min) {
-  range_tree_node *spare;
+static range_tree_node *range_tree_node_delete_ge(
+  range_tree_node *node,
+  uint64_t min
+) {
   if (!node) return NULL;
 
   if (node->max < min) {
@@ -104,15 +84,13 @@ range_tree_node *range_tree_node_delete_ge(range_tree_node *node, uint64_t min)
     return node;
   }
 
-  spare = node->left;
-  node->left = NULL;
-
-  range_tree_node_free(node);
-  return range_tree_node_delete_ge(spare, min);
+  return range_tree_node_delete_ge(node->left, min);
 }
 
-range_tree_node *range_tree_node_delete_le(range_tree_node *node, uint64_t max) {
-  range_tree_node *spare;
+static range_tree_node *range_tree_node_delete_le(
+  range_tree_node *node,
+  uint64_t max
+) {
   if (!node) return NULL;
 
   if (max < node->min) {
@@ -125,31 +103,28 @@ range_tree_node *range_tree_node_delete_le(range_tree_node *node, uint64_t max)
     return node;
   }
 
-  spare = node->right;
-  node->right = NULL;
-
-  range_tree_node_free(node);
-  return range_tree_node_delete_le(spare, max);
+  return range_tree_node_delete_le(node->right, max);
 }
 
-range_tree_node *range_tree_node_insert(
+static range_tree_node *range_tree_node_insert(
+  aoc_arena *arena,
   range_tree_node *node,
   uint64_t min,
   uint64_t max
 ) {
   if (!node) {
-    node = malloc(sizeof(range_tree_node));
+    node = aoc_arena_new(arena, range_tree_node);
     *node = (range_tree_node){min, max};
     return node;
   }
 
   if (max < node->min) {
-    node->left = range_tree_node_insert(node->left, min, max);
+    node->left = range_tree_node_insert(arena, node->left, min, max);
     return node;
   }
 
   if (node->max < min) {
-    node->right = range_tree_node_insert(node->right, min, max);
+    node->right = range_tree_node_insert(arena, node->right, min, max);
     return node;
   }
 
@@ -170,11 +145,11 @@ range_tree_node *range_tree_node_insert(
   return node;
 }
 
-void range_tree_insert(range_tree *tree, uint64_t min, uint64_t max) {
-  tree->root = range_tree_node_insert(tree->root, min, max);
+static void range_tree_insert(range_tree *tree, uint64_t min, uint64_t max) {
+  tree->root = range_tree_node_insert(&tree->arena, tree->root, min, max);
 }
 
-bool range_tree_node_contains(range_tree_node *node, uint64_t value) {
+static bool range_tree_node_contains(range_tree_node *node, uint64_t value) {
   if (!node) return false;
 
   if (value < node->min) {
@@ -186,11 +161,11 @@ bool range_tree_node_contains(range_tree_node *node, uint64_t value) {
   }
 }
 
-bool range_tree_contains(range_tree *tree, uint64_t value) {
+static bool range_tree_contains(range_tree *tree, uint64_t value) {
   return range_tree_node_contains(tree->root, value);
 }
 
-uint64_t range_tree_node_count(range_tree_node *node) {
+static uint64_t range_tree_node_count(range_tree_node *node) {
   uint64_t count = 0;
   if (!node) return 0;
   
@@ -200,37 +175,61 @@ uint64_t range_tree_node_count(range_tree_node *node) {
   return count;
 }
 
-uint64_t range_tree_count(range_tree *tree) {
+static uint64_t range_tree_count(range_tree *tree) {
   return range_tree_node_count(tree->root);
 }
 
-void part1(char const *input) {
+// Map one id to whether it falls in any range of the tree in `ctx`.
+static bool map_lookup(void *ctx, char const **input, uint64_t *value) {
+  iterator it = {*input};
+
+  if (!next_value(&it)) return false;
+  *value = range_tree_contains(ctx, it.min);
+  *input = it.input;
+  return true;
+}
+
+uint64_t part1(char const *input) {
+  aoc_mapreduce mr = {.map = map_lookup};
   iterator it = {input};
   range_tree tree = {0};
   uint64_t total = 0;
 
+  aoc_trace_begin("insert");
   while (next_range(&it)) {
     range_tree_insert(&tree, it.min, it.max);
   }
+  aoc_trace_end();
 
-  while (next_value(&it)) {
-    total += range_tree_contains(&tree, it.min);
-  }
+  // Lookups only read the tree, so they run in parallel.
+  aoc_trace_begin("lookup");
+  mr.ctx = &tree;
+  total = aoc_mapreduce_run(&mr, it.input, strlen(it.input));
+  aoc_trace_end();
 
-  printf("%" PRIu64 "\n", total);
+  aoc_trace_begin("free");
   range_tree_free(&tree);
+  aoc_trace_end();
+  return total;
 }
 
-void part2(char const *input) {
+uint64_t part2(char const *input) {
   iterator it = {input};
   range_tree tree = {0};
   uint64_t total;
 
+  aoc_trace_begin("insert");
   while (next_range(&it)) {
     range_tree_insert(&tree, it.min, it.max);
   }
+  aoc_trace_end();
 
+  aoc_trace_begin("count");
   total = range_tree_count(&tree);
-  printf("%" PRIu64 "\n", total);
+  aoc_trace_end();
+
+  aoc_trace_begin("free");
   range_tree_free(&tree);
+  aoc_trace_end();
+  return total;
 }
@@ -4,128 +4,128 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
-#include <stdlib.h>
 
-#define arrlen(array) (sizeof(array) / sizeof(*(array)))
+#include <aoc-grid.h>
+#include <aoc-mapreduce.h>
+#include <aoc-parse.h>
+#include <aoc-trace.h>
 
-typedef struct grid {
-  char const *data;
-  size_t stride;
-  size_t height;
-  size_t width;
-} grid;
+// The most rows of numbers a problem can have.
+#define MAX_NUMBERS (19)
 
-grid measure(char const *input) {
-  grid g = {input};
+// Combine the `nstack` numbers of a problem with its operator.
+static uint64_t reduce(char op, uint64_t const *stack, size_t nstack) {
+  uint64_t value = stack[0];
+  size_t i;
 
-  for (; *input != '\n'; input++) {
-    g.width++;
-  }
-  g.stride = g.width + 1;
-
-  for (; *input != '\0'; input++) {
-    g.height += (*input == '\n');
+  if (op == '+') {
+    for (i = 1; i < nstack; i++) {
+      value += stack[i];
+    }
+  } else {
+    assert(op == '*');
+    for (i = 1; i < nstack; i++) {
+      value *= stack[i];
+    }
   }
 
-  return g;
+  return value;
 }
 
-char get(grid const *g, size_t x, size_t y) {
-  if (x >= g->width || y >= g->height) return '\0';
-  return g->data[x + y * g->stride];
+// Problems start at the operators in the last row and run up to the next one.
+// The fill past the end of a short operator row reads as NUL, and is skipped
+// like the spaces.
+static char const *next_problem(void *ctx, char const *at, char const *end) {
+  (void)ctx;
+  while (at < end && (isspace(*at) || *at == '\0')) at++;
+  return at;
 }
 
-void part1(char const *input) {
-  uint64_t stack[20];
-  uint64_t total = 0;
-  size_t nstack = 0;
-  size_t offset = 0;
-  size_t line;
-  char op;
+static bool map_rows(void *ctx, char const **input, uint64_t *value) {
+  aoc_grid const *g = ctx;
+  char const *ops = aoc_grid_row(g, g->height - 1);
+  size_t offset = *input - ops;
+  uint64_t stack[MAX_NUMBERS];
+  size_t line, nstack = 0;
   char const *text;
+  char op;
 
-  grid g = measure(input);
-  assert(g.height < arrlen(stack));
-
-  while ((op = get(&g, offset, g.height - 1))) {
-    // For each of the lines with numbers in them, parse the number and push it
-    // onto a stack for later.
-    for (line = 0; line < g.height - 1; line++) {
-      text = &g.data[offset + line * g.stride];
-      stack[nstack++] = strtoul(text, NULL, 10);
-    }
-
-    // Once we have all of the numbers parsed, accumulate everything in the
-    // stack together and add it to the grand total. Then reset the stack.
-    if (op == '+') {
-      while (nstack > 1) {
-        stack[0] += stack[--nstack];
-      }
-    } else {
-      assert(op == '*');
-      while (nstack > 1) {
-        stack[0] *= stack[--nstack];
-      }
-    }
-    total += stack[0];
-    nstack = 0;
+  if (!(op = ops[offset])) return false;
 
-    // Scan across the last line to find the next operator.
-    for (offset++; isspace(get(&g, offset, g.height - 1)); offset++) {}
+  // For each of the lines with numbers in them, parse the number and push it
+  // onto a stack. Numbers may be right-aligned in their column, so skip any
+  // leading spaces first.
+  for (line = 0; line < g->height - 1; line++) {
+    text = aoc_grid_row(g, line) + offset;
+    aoc_parse_space(&text);
+    stack[nstack] = 0;
+    aoc_parse_u64(&text, &stack[nstack++]);
   }
+  *value = reduce(op, stack, nstack);
 
-  printf("%" PRIu64 "\n", total);
+  // Scan across the last line to find the next operator.
+  *input = next_problem(NULL, ops + offset + 1, ops + g->width);
+  return true;
 }
 
-void part2(char const *input) {
-  uint64_t stack[20];
-  uint64_t total = 0;
-  size_t nstack = 0;
-  size_t row, col;
-  char c;
+static bool map_columns(void *ctx, char const **input, uint64_t *value) {
+  aoc_grid const *g = ctx;
+  char const *ops = aoc_grid_row(g, g->height - 1);
+  size_t offset = *input - ops;
+  uint64_t stack[MAX_NUMBERS];
+  size_t col, row, nstack = 0;
+  char c, op;
+
+  if (!(op = ops[offset])) return false;
 
-  grid g = measure(input);
-  assert(g.height < arrlen(stack));
+  // Each column up to the next operator holds one number, read top to bottom.
+  // The blank column between problems reads as zero and is left out. The
+  // operator row may be shorter than the others, and the fill past its end
+  // counts as blank too.
+  for (col = offset; col < g->width; col++) {
+    if (col != offset && ops[col] != ' ' && ops[col] != '\0') break;
 
-  for (col = g.width - 1; col < g.width; col--) {
-    // Scan down the rows, building up the current slot in the stack with the
-    // digits as we find them.
     stack[nstack] = 0;
-    for (row = 0; row < g.height - 1; row++) {
-      c = get(&g, col, row);
+    for (row = 0; row < g->height - 1; row++) {
+      c = aoc_grid_row(g, row)[col];
       if ('0' <= c && c <= '9') {
         stack[nstack] *= 10;
         stack[nstack] += c - '0';
       }
     }
-
-    // If this wasn't an empty column, move onto the next slot in the stack.
     if (stack[nstack] != 0) nstack++;
-
-    // Check if the last row has an operator in it. If it does, then we
-    // accumulate everything in the stack and add it to the grand total, before
-    // resetting the stack.
-    switch (get(&g, col, g.height - 1)) {
-      case '+':
-        while (nstack > 1) {
-          stack[0] += stack[--nstack];
-        }
-        total += stack[0];
-        nstack = 0;
-        break;
-
-      case '*':
-        while (nstack > 1) {
-          stack[0] *= stack[--nstack];
-        }
-        total += stack[0];
-        nstack = 0;
-        break;
-
-      default:
-        break;
-    }
   }
+  *value = nstack ? reduce(op, stack, nstack) : 0;
+
+  *input = ops + col;
+  return true;
+}
+
+// Problems are independent, so they are solved in parallel and summed.
+static uint64_t solve(char const *input, aoc_map_fn map) {
+  aoc_mapreduce mr = {.map = map, .split = next_problem};
+  uint64_t total;
+  aoc_grid g;
+
+  aoc_trace_begin("measure");
+  aoc_grid_load(&g, input, 1, '\0');
+  assert(g.height - 1 <= MAX_NUMBERS);
+  mr.ctx = &g;
+  mr.weight = g.height;
+  aoc_trace_end();
+
+  aoc_trace_begin("problems");
+  total = aoc_mapreduce_run(&mr, aoc_grid_row(&g, g.height - 1), g.width);
+  aoc_trace_end();
+
+  aoc_grid_free(&g);
+  return total;
+}
+
+uint64_t part1(char const *input) {
+  return solve(input, map_rows);
+}
 
-  printf("%" PRIu64 "\n", total);
+uint64_t part2(char const *input) {
+  return solve(input, map_columns);
 }
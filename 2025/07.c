@@ -1,56 +1,44 @@
-#include <assert.h>
 #include <inttypes.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-typedef struct grid {
-  size_t width;
-  size_t height;
-  size_t stride;
-  size_t startx;
-} bounds;
+#include <aoc-grid.h>
+#include <aoc-trace.h>
 
-bounds measure(char const *data) {
-  bounds g = {0};
-
-  while (data[g.startx] != 'S') {
-    g.startx++;
-    g.width++;
-  }
-
-  while (data[g.width] != '\n') {
-    g.width++;
-  }
-  g.stride = g.width + 1;
-
-  for (; *data != '\0'; data++) {
-    g.height += (*data == '\n');
-  }
-
-  return g;
+// Find the column of the 'S' the beam starts from.
+static size_t start(aoc_grid const *g) {
+  char const *row = aoc_grid_row(g, 0);
+  return (char const *)memchr(row, 'S', g->width) - row;
 }
 
-void part1(char const *input) {
-  bounds b = measure(input);
-  size_t x, y;
+// The beam arrays have a slot past either edge of the grid, like its border,
+// so a splitter in the first or last column needs no bounds checks. Beams that
+// leave the grid land in those slots and are never read back.
+uint64_t part1(char const *input) {
+  aoc_grid b;
+  ptrdiff_t x;
+  size_t y;
   uint64_t total = 0;
-  bool *swap, *beams[2];
-
-  beams[0] = calloc(b.width, sizeof(bool));
-  beams[1] = calloc(b.width, sizeof(bool));
-  if (!beams[0] || !beams[1]) abort();
-
-  beams[0][b.startx] = true;
+  char const *row;
+  bool *swap, *slots[2], *beams[2];
+
+  aoc_grid_load(&b, input, 1, '.');
+  slots[0] = calloc(b.width + 2, sizeof(bool));
+  slots[1] = calloc(b.width + 2, sizeof(bool));
+  if (!slots[0] || !slots[1]) abort();
+  beams[0] = slots[0] + 1;
+  beams[1] = slots[1] + 1;
+
+  aoc_trace_begin("beams");
+  beams[0][start(&b)] = true;
   for (y = 1; y < b.height; y++) {
-    memset(beams[1], 0, b.width * sizeof(bool));
-
-    for (x = 0; x < b.width; x++) {
-      if (input[x + y * b.stride] == '^') {
-        assert(x > 0);
-        assert(x < b.width - 1);
+    memset(beams[1] - 1, 0, (b.width + 2) * sizeof(bool));
+    row = aoc_grid_row(&b, y);
 
+    for (x = 0; x < (ptrdiff_t)b.width; x++) {
+      if (row[x] == '^') {
         beams[1][x - 1] |= beams[0][x];
         beams[1][x + 1] |= beams[0][x];
         total += beams[0][x];
@@ -63,31 +51,37 @@ void part1(char const *input) {
     beams[0] = beams[1];
     beams[1] = swap;
   }
+  aoc_trace_end();
 
-  printf("%" PRIu64 "\n", total);
-  free(beams[0]);
-  free(beams[1]);
+  free(slots[0]);
+  free(slots[1]);
+  aoc_grid_free(&b);
+  return total;
 }
 
-void part2(char const *input) {
-  bounds b = measure(input);
-  size_t x, y;
+uint64_t part2(char const *input) {
+  aoc_grid b;
+  ptrdiff_t x;
+  size_t y;
   uint64_t total = 0;
-  uint64_t *swap, *beams[2];
-
-  beams[0] = calloc(b.width, sizeof(uint64_t));
-  beams[1] = calloc(b.width, sizeof(uint64_t));
-  if (!beams[0] || !beams[1]) abort();
-
-  beams[0][b.startx] = 1;
+  char const *row;
+  uint64_t *swap, *slots[2], *beams[2];
+
+  aoc_grid_load(&b, input, 1, '.');
+  slots[0] = calloc(b.width + 2, sizeof(uint64_t));
+  slots[1] = calloc(b.width + 2, sizeof(uint64_t));
+  if (!slots[0] || !slots[1]) abort();
+  beams[0] = slots[0] + 1;
+  beams[1] = slots[1] + 1;
+
+  aoc_trace_begin("beams");
+  beams[0][start(&b)] = 1;
   for (y = 1; y < b.height; y++) {
-    memset(beams[1], 0, b.width * sizeof(uint64_t));
+    memset(beams[1] - 1, 0, (b.width + 2) * sizeof(uint64_t));
+    row = aoc_grid_row(&b, y);
 
-    for (x = 0; x < b.width; x++) {
-      if (input[x + y * b.stride] == '^') {
-        assert(x > 0);
-        assert(x < b.width - 1);
-        
+    for (x = 0; x < (ptrdiff_t)b.width; x++) {
+      if (row[x] == '^') {
         beams[1][x - 1] += beams[0][x];
         beams[1][x + 1] += beams[0][x];
       } else {
@@ -99,12 +93,14 @@ void part2(char const *input) {
     beams[0] = beams[1];
     beams[1] = swap;
   }
+  aoc_trace_end();
 
-  for (x = 0; x < b.width; x++) {
+  for (x = 0; x < (ptrdiff_t)b.width; x++) {
     total += beams[0][x];
   }
 
-  printf("%" PRIu64 "\n", total);
-  free(beams[0]);
-  free(beams[1]);
+  free(slots[0]);
+  free(slots[1]);
+  aoc_grid_free(&b);
+  return total;
 }
@@ -6,6 +6,9 @@
 #include <string.h>
 
 #include <aoc-array.h>
+#include <aoc-parse.h>
+#include <aoc-sort.h>
+#include <aoc-trace.h>
 
 typedef struct vec3 {
   uint32_t x;
@@ -13,11 +16,7 @@ typedef struct vec3 {
   uint32_t z;
 } vec3;
 
-typedef struct vec3_list {
-  vec3 *items;
-  size_t count;
-  size_t capacity;
-} vec3_list;
+AOC_ARRAY_STATIC(vec3_list, vec3)
 
 typedef struct vec3_pair {
   uint64_t distance;
@@ -30,57 +29,37 @@ typedef struct vec3_pair_list {
   size_t count;
 } vec3_pair_list;
 
-uint64_t vec3_distance(vec3 a, vec3 b) {
+static uint64_t vec3_distance(vec3 a, vec3 b) {
   uint64_t dx = (a.x > b.x) ? (a.x - b.x) : (b.x - a.x);
   uint64_t dy = (a.y > b.y) ? (a.y - b.y) : (b.y - a.y);
   uint64_t dz = (a.z > b.z) ? (a.z - b.z) : (b.z - a.z);
   return dx * dx + dy * dy + dz * dz;
 }
 
-void vec3_list_ensure_capacity(vec3_list *list, size_t target) {
-  size_t capacity;
-  vec3 *items;
-
-  if (list->capacity < target) {
-    capacity = list->capacity ? list->capacity : 16;
-    for (; capacity < target; capacity *= 2) {}
-
-    items = realloc(list->items, capacity * sizeof(vec3));
-    if (!items) abort();
-
-    list->items = items;
-    list->capacity = capacity;
-  }
-}
-
-void vec3_list_append(vec3_list *list, vec3 item) {
-  vec3_list_ensure_capacity(list, list->count + 1);
-  list->items[list->count++] = item;
-}
-
-void vec3_list_free(vec3_list *list) {
-  free(list->items);
-  memset(list, 0, sizeof(vec3_list));
-}
-
-vec3_list vec3_list_new(char const *input) {
+static vec3_list vec3_list_new(char const *input) {
+  uint64_t coords[3];
   vec3 v;
-  size_t n;
   vec3_list list = {0};
 
-  while (sscanf(input, "%u,%u,%u\n%zn", &v.x, &v.y, &v.z, &n) == 3) {
-    vec3_list_append(&list, v);
-    input += n;
+  aoc_trace_begin("parse");
+  while (aoc_parse_tuple(&input, ',', coords, 3) == 3) {
+    v.x = coords[0];
+    v.y = coords[1];
+    v.z = coords[2];
+    vec3_list_push(&list, v);
+    aoc_parse_space(&input);
   }
+  aoc_trace_end();
 
   return list;
 }
 
-vec3_pair_list vec3_pair_list_new(vec3_list const *vecs) {
+static vec3_pair_list vec3_pair_list_new(vec3_list const *vecs) {
   vec3_pair_list pairs = {0};
   vec3_pair *pair;
   size_t lid, rid;
 
+  aoc_trace_begin("pairs");
   pairs.count = ((vecs->count - 1) * vecs->count) / 2;
   pairs.items = malloc(pairs.count * sizeof(*pairs.items));
   pair = pairs.items;
@@ -93,55 +72,36 @@ vec3_pair_list vec3_pair_list_new(vec3_list const *vecs) {
       pair++;
     }
   }
+  aoc_trace_end();
 
   return pairs;
 }
 
-void vec3_pair_swap(vec3_pair *a, vec3_pair *b) {
-  vec3_pair temp = *a;
-  *a = *b;
-  *b = temp;
-}
-
-void vec3_pair_list_quicksort(vec3_pair_list *list, size_t lo, size_t hi) {
-  size_t i, j;
-  uint64_t pivot;
-
-  if (lo >= hi || hi > list->count) return;
-
-  pivot = list->items[hi].distance;
-
-  for (i = j = lo; j < hi; j++) {
-    if (list->items[j].distance <= pivot) {
-      vec3_pair_swap(list->items + j, list->items + i);
-      i++;
-    }
-  }
-  vec3_pair_swap(list->items + i, list->items + hi);
-
-  vec3_pair_list_quicksort(list, lo, i - 1);
-  vec3_pair_list_quicksort(list, i + 1, hi);
+static uint64_t vec3_pair_key(void const *item) {
+  return ((vec3_pair const *)item)->distance;
 }
 
-void vec3_pair_list_sort(vec3_pair_list *list) {
-  if (list->count == 0) return;
-  vec3_pair_list_quicksort(list, 0, list->count - 1);
+// Sort the pairs by distance. Only the first `limit` pairs are guaranteed to be
+// in order.
+static void vec3_pair_list_sort(vec3_pair_list *list, size_t limit) {
+  aoc_trace_begin("sort");
+  aoc_sort_top(
+    list->items,
+    list->count,
+    sizeof(*list->items),
+    vec3_pair_key,
+    AOC_SORT_ASCENDING,
+    limit
+  );
+  aoc_trace_end();
 }
 
-void vec3_pair_list_free(vec3_pair_list *list) {
+static void vec3_pair_list_free(vec3_pair_list *list) {
   free(list->items);
   memset(list, 0, sizeof(vec3_pair_list));
 }
 
-bool all(bool const *conds, size_t len) {
-  size_t i;
-  for (i = 0; i < len; i++) {
-    if (!conds[i]) return false;
-  }
-  return true;
-}
-
-void part1(char const *input) {
+uint64_t part1(char const *input) {
   size_t i, j;
   uint32_t old, new;
   uint64_t total = 1;
@@ -156,7 +116,9 @@ void part1(char const *input) {
     assign[i] = i;
   }
 
-  vec3_pair_list_sort(&pairs);
+  vec3_pair_list_sort(&pairs, 1000);
+
+  aoc_trace_begin("union");
   for (i = 0; i < 1000; i++) {
     pair = pairs.items + i;
 
@@ -176,20 +138,23 @@ void part1(char const *input) {
       circuits.items[old] = 0;
     }
   }
+  aoc_trace_end();
 
+  aoc_trace_begin("circuits");
   aoc_array_sort(&circuits);
   for (i = 1; i <= 3; i++) {
     total *= circuits.items[circuits.count - i];
   }
-  printf("%" PRIu64 "\n", total);
+  aoc_trace_end();
 
   free(assign);
   aoc_array_free(&circuits);
   vec3_pair_list_free(&pairs);
   vec3_list_free(&vecs);
+  return total;
 }
 
-void part2(char const *input) {
+uint64_t part2(char const *input) {
   size_t i, j;
   uint32_t old, new;
   uint64_t total = 1;
@@ -203,7 +168,9 @@ void part2(char const *input) {
     assign[i] = i;
   }
 
-  vec3_pair_list_sort(&pairs);
+  vec3_pair_list_sort(&pairs, pairs.count);
+
+  aoc_trace_begin("union");
   for (i = 0; i < pairs.count; i++) {
     pair = pairs.items + i;
 
@@ -220,12 +187,13 @@ void part2(char const *input) {
 
     if (ncircuits == 1) break;
   }
+  aoc_trace_end();
 
   total *= vecs.items[pair->lid].x;
   total *= vecs.items[pair->rid].x;
-  printf("%" PRIu64 "\n", total);
 
   free(assign);
   vec3_pair_list_free(&pairs);
   vec3_list_free(&vecs);
+  return total;
 }
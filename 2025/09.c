@@ -6,6 +6,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <aoc-array.h>
+#include <aoc-parse.h>
+#include <aoc-sort.h>
+#include <aoc-trace.h>
 #include <cairo/cairo.h>
 #include <unistd.h>
 
@@ -17,11 +21,7 @@ typedef struct vec2 {
   uint64_t y;
 } vec2;
 
-typedef struct vec2_list {
-  vec2 *items;
-  size_t count;
-  size_t capacity;
-} vec2_list;
+AOC_ARRAY_STATIC(vec2_list, vec2)
 
 typedef struct rect {
   uint64_t x0;
@@ -35,74 +35,36 @@ typedef struct rect_list {
   size_t count;
 } rect_list;
 
-void vec2_list_ensure_capacity(vec2_list *list, size_t target) {
-  size_t capacity;
-  vec2 *items;
-
-  if (list->capacity < target) {
-    capacity = list->capacity ? list->capacity : 16;
-    for (; capacity < target; capacity *= 2) {}
-
-    items = realloc(list->items, capacity * sizeof(*items));
-    if (!items) abort();
-
-    list->items = items;
-    list->capacity = capacity;
-  }
-}
-
-vec2_list vec2_list_new(char const *input) {
-  size_t n;
-  vec2 v;
+static vec2_list vec2_list_new(char const *input) {
+  uint64_t coords[2];
   vec2_list list = {0};
 
-  while (sscanf(input, "%lu,%lu\n%zn", &v.x, &v.y, &n) == 2) {
-    vec2_list_ensure_capacity(&list, list.count + 1);
-    list.items[list.count++] = v;
-    input += n;
+  aoc_trace_begin("parse");
+  while (aoc_parse_tuple(&input, ',', coords, 2) == 2) {
+    vec2_list_push(&list, (vec2){coords[0], coords[1]});
+    aoc_parse_space(&input);
   }
+  aoc_trace_end();
 
   return list;
 }
 
-void vec2_list_free(vec2_list *list) {
-  free(list->items);
-  memset(list, 0, sizeof(*list));
-}
-
-void rect_swap(rect *a, rect *b) {
-  rect temp = *a;
-  *a = *b;
-  *b = temp;
-}
-
-uint64_t rect_area(rect r) {
+static uint64_t rect_area(rect r) {
   return (r.x1 - r.x0 + 1) * (r.y1 - r.y0 + 1);
 }
 
-void rect_list_quicksort(rect_list *list, size_t lo, size_t hi) {
-  size_t i, j;
-  uint64_t pivot;
-
-  if (lo >= hi || hi >= list->count) return;
-  pivot = rect_area(list->items[hi]);
-
-  for (i = j = lo; j < hi; j++) {
-    if (rect_area(list->items[j]) >= pivot) {
-      rect_swap(list->items + i, list->items + j);
-      i++;
-    }
-  }
-  rect_swap(list->items + i, list->items + hi);
-  rect_list_quicksort(list, lo, i - 1);
-  rect_list_quicksort(list, i + 1, hi);
+static uint64_t rect_key(void const *item) {
+  return rect_area(*(rect const *)item);
 }
 
-rect_list rect_list_candidates(vec2_list const *vecs) {
+// Return every rectangle with two of `vecs` as opposite corners, largest first.
+// Only the first `limit` rectangles are guaranteed to be in order.
+static rect_list rect_list_candidates(vec2_list const *vecs, size_t limit) {
   size_t i, j;
   rect_list rects;
   rect *r;
 
+  aoc_trace_begin("candidates");
   rects.count = (vecs->count - 1) * vecs->count / 2;
   rects.items = malloc(rects.count * sizeof(*rects.items));
   r = rects.items;
@@ -116,12 +78,23 @@ rect_list rect_list_candidates(vec2_list const *vecs) {
       r++;
     }
   }
+  aoc_trace_end();
+
+  aoc_trace_begin("sort");
+  aoc_sort_top(
+    rects.items,
+    rects.count,
+    sizeof(*rects.items),
+    rect_key,
+    AOC_SORT_DESCENDING,
+    limit
+  );
+  aoc_trace_end();
 
-  rect_list_quicksort(&rects, 0, rects.count - 1);
   return rects;
 }
 
-rect_list rect_list_lines(vec2_list const *vecs) {
+static rect_list rect_list_lines(vec2_list const *vecs) {
   size_t i;
   rect_list rects;
   rect *r;
@@ -144,18 +117,18 @@ rect_list rect_list_lines(vec2_list const *vecs) {
   return rects;
 }
 
-void rect_list_free(rect_list *list) {
+static void rect_list_free(rect_list *list) {
   free(list->items);
   memset(list, 0, sizeof(*list));
 }
 
-bool rect_overlaps(rect cand, rect line) {
+static bool rect_overlaps(rect cand, rect line) {
   bool outx = cand.x1 <= line.x0 || line.x1 <= cand.x0;
   bool outy = cand.y1 <= line.y0 || line.y1 <= cand.y0;
   return !outx && !outy;
 }
 
-bool rect_validate(rect cand, rect_list const *lines) {
+static bool rect_validate(rect cand, rect_list const *lines) {
   rect *l = lines->items;
   rect *end = l + lines->count;
 
@@ -166,32 +139,33 @@ bool rect_validate(rect cand, rect_list const *lines) {
   return true;
 }
 
-void part1(char const *input) {
+uint64_t part1(char const *input) {
   vec2_list vecs = vec2_list_new(input);
-  rect_list rects = rect_list_candidates(&vecs);
+  rect_list rects = rect_list_candidates(&vecs, 1);
   uint64_t area = rect_area(rects.items[0]);
 
-  printf("%" PRIu64 "\n", area);
-
   rect_list_free(&rects);
   vec2_list_free(&vecs);
+  return area;
 }
 
-void part2(char const *input) {
+uint64_t part2(char const *input) {
   vec2_list vecs = vec2_list_new(input);
-  rect_list rects = rect_list_candidates(&vecs);
+  rect_list rects = rect_list_candidates(&vecs, SIZE_MAX);
   rect_list lines = rect_list_lines(&vecs);
   uint64_t area;
   size_t r, l;
 
+  aoc_trace_begin("validate");
   for (r = 0; r < rects.count; r++) {
     if (rect_validate(rects.items[r], &lines)) break;
   }
+  aoc_trace_end();
 
   area = rect_area(rects.items[r]);
-  printf("%" PRIu64 "\n", area);
 
   rect_list_free(&lines);
   rect_list_free(&rects);
   vec2_list_free(&vecs);
+  return area;
 }
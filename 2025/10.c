@@ -8,14 +8,15 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include <aoc-array.h>
+#include <aoc-mapreduce.h>
+#include <aoc-parse.h>
+#include <aoc-stream.h>
+#include <aoc-trace.h>
 
 #define arrlen(array) (sizeof(array) / sizeof((array)[0]))
 
 #define MAX_TARGETS (10)
 #define MAX_BUTTONS (20)
-#define MAX_CONDITIONS (20)
-#define MAX_VARIABLES (40)
 
 typedef struct iterator {
   char const *input;
@@ -26,10 +27,9 @@ typedef struct iterator {
   uint16_t buttons[MAX_BUTTONS];
 } iterator;
 
-bool next(iterator *iter) {
+static bool next(iterator *iter) {
   uint16_t mask;
   uint64_t value;
-  char *end;
 
   iter->targets = 0;
   iter->indicators = 0;
@@ -90,10 +90,9 @@ bool next(iterator *iter) {
   iter->input++;
 
   while (*iter->input != '}') {
-    value = strtoul(iter->input, &end, 10);
+    aoc_parse_u64(&iter->input, &value);
     iter->joltages[iter->targets++] = value;
 
-    iter->input = end;
     if (*iter->input == ',') {
       iter->input++;
     }
@@ -105,110 +104,83 @@ bool next(iterator *iter) {
   return true;
 }
 
-uint64_t integer_gcd(uint64_t a, uint64_t b) {
-  if (a == 0) return b;
-  return integer_gcd(b % a, a);
-}
-
-uint64_t integer_lcm(uint64_t a, uint64_t b) {
-  return a / integer_gcd(a, b) * b;
-}
+typedef __int128 i128;
 
+// Coefficients are kept as 64-bit fractions in lowest terms, but every
+// operation works in 128 bits and only has to fit again once reduced. The
+// Big-M objective and the cuts grow the fractions well past 32 bits, so a
+// result that still does not fit is caught here instead of wrapping.
 typedef struct rational {
-  int32_t num;
-  int32_t den;
+  int64_t num;
+  int64_t den;
 } rational;
 
-void rational_simplify(rational *value) {
-  int32_t sign;
-  uint32_t num, den, gcd;
+static i128 wide_gcd(i128 a, i128 b) {
+  i128 t;
 
-  if (value->den < 0) {
-    value->num = -value->num;
-    value->den = -value->den;
+  while (a != 0) {
+    t = b % a;
+    b = a;
+    a = t;
   }
 
-  sign = (value->num > 0) - (value->num < 0);
-  num = value->num * sign;
-  den = value->den;
+  return b;
+}
+
+static rational rational_reduce(i128 num, i128 den) {
+  i128 gcd;
+
+  assert(den != 0);
+  if (den < 0) {
+    num = -num;
+    den = -den;
+  }
 
-  gcd = integer_gcd(num, den);
+  gcd = wide_gcd(num < 0 ? -num : num, den);
   num /= gcd;
   den /= gcd;
 
-  value->num = ((int32_t)num) * sign;
-  value->den = ((int32_t)den);
+  assert(num >= INT64_MIN && num <= INT64_MAX && den <= INT64_MAX);
+  return (rational){(int64_t)num, (int64_t)den};
 }
 
-bool rational_positive(rational value) {
+static bool rational_positive(rational value) {
   assert(value.den > 0);
   return value.num > 0;
 }
 
-bool rational_negative(rational value) {
+static bool rational_negative(rational value) {
   assert(value.den > 0);
   return value.num < 0;
 }
 
-rational rational_fpart(rational value) {
-  int32_t n = value.num % value.den;
+static rational rational_fpart(rational value) {
+  int64_t n = value.num % value.den;
   value.num = n < 0 ? n + value.den : n;
   return value;
 }
 
-rational rational_ipart(rational value) {
-  int32_t m = value.num % value.den;
-  value.num /= value.den;
-  value.num -= (m != 0 && ((m < 0) != (value.den < 0)));
-  value.den = 1;
-  return value;
-}
-
-int rational_cmp(rational lhs, rational rhs) {
-  if (rational_negative(lhs)) {
-    if (!rational_negative(rhs)) {
-      return -1;
-    }
-    lhs.num = -lhs.num;
-    rhs.num = -rhs.num;
-    return rational_cmp(rhs, lhs);
-  }
-
-  if (rational_negative(rhs)) {
-    return 1;
-  }
+static int rational_cmp(rational lhs, rational rhs) {
+  i128 ln, rn;
 
-  uint64_t ln, rn, lcm;
-  lcm = integer_lcm(lhs.den, rhs.den);
-  ln = (lcm / lhs.den) * lhs.num;
-  rn = (lcm / rhs.den) * rhs.num;
+  assert(lhs.den > 0 && rhs.den > 0);
+  ln = (i128)lhs.num * rhs.den;
+  rn = (i128)rhs.num * lhs.den;
 
   return (ln > rn) - (ln < rn);
 }
 
-bool rational_gt(rational lhs, rational rhs) {
-  return rational_cmp(lhs, rhs) > 0;
-}
-
-bool rational_ge(rational lhs, rational rhs) {
-  return rational_cmp(lhs, rhs) >= 0;
-}
-
-bool rational_lt(rational lhs, rational rhs) {
+static bool rational_lt(rational lhs, rational rhs) {
   return rational_cmp(lhs, rhs) < 0;
 }
 
-bool rational_le(rational lhs, rational rhs) {
-  return rational_cmp(lhs, rhs) <= 0;
-}
-
-rational rational_neg(rational value) {
+static rational rational_neg(rational value) {
   value.num = -value.num;
   return value;
 }
 
-rational rational_reciprocal(rational value) {
-  int32_t temp = value.den;
+static rational rational_reciprocal(rational value) {
+  int64_t temp = value.den;
   value.den = value.num;
   value.num = temp;
 
@@ -216,91 +188,99 @@ rational rational_reciprocal(rational value) {
   return value;
 }
 
-void rational_addeq(rational *dst, rational src) {
-  uint64_t lcm;
-
+static void rational_addeq(rational *dst, rational src) {
   assert(dst->den > 0 && src.den > 0);
-  lcm = integer_lcm(dst->den, src.den);
-  dst->num *= (lcm / dst->den);
-  src.num *= (lcm / src.den);
-
-  dst->num += src.num;
-  dst->den = lcm;
-  rational_simplify(dst);
-}
-
-void rational_subeq(rational *dst, rational src) {
-  src.num = -src.num;
-  rational_addeq(dst, src);
+  *dst = rational_reduce(
+    (i128)dst->num * src.den + (i128)src.num * dst->den,
+    (i128)dst->den * src.den
+  );
 }
 
-void rational_muleq(rational *dst, rational src) {
-  dst->num *= src.num;
-  dst->den *= src.den;
-  rational_simplify(dst);
+static void rational_muleq(rational *dst, rational src) {
+  *dst = rational_reduce((i128)dst->num * src.num, (i128)dst->den * src.den);
 }
 
-rational rational_mul(rational lhs, rational rhs) {
+static rational rational_mul(rational lhs, rational rhs) {
   rational_muleq(&lhs, rhs);
   return lhs;
 }
 
-void rational_diveq(rational *dst, rational src) {
-  dst->num *= src.den;
-  dst->den *= src.num;
-  rational_simplify(dst);
+static void rational_diveq(rational *dst, rational src) {
+  *dst = rational_reduce((i128)dst->num * src.den, (i128)dst->den * src.num);
 }
 
-rational rational_div(rational lhs, rational rhs) {
+static rational rational_div(rational lhs, rational rhs) {
   rational_diveq(&lhs, rhs);
   return lhs;
 }
 
+// Every cut adds a row and a column to the table, and there is no useful bound
+// on how many cuts a machine needs, so the table grows as they are added.
 typedef struct linprog {
-  rational coeff[MAX_CONDITIONS][MAX_VARIABLES];
+  // Row y starts at coeff[y]; the rows share one allocation, `height` rows of
+  // `width` cells, and every cell not in use is zero.
+  rational **coeff;
+  rational *cells;
+  size_t height;
+  size_t width;
   uint32_t conditions;
   uint32_t variables;
 } linprog;
 
-void linprog_dump(linprog *lp) {
-  int w, widths[MAX_VARIABLES] = {0};
-  char buffer[50];
-  size_t col, row;
-  rational r;
-
-  for (col = 0; col <= lp->variables; col++) {
-    for (row = 0; row <= lp->conditions; row++) {
-      r = lp->coeff[row][col];
-      w = snprintf(NULL, 0, "%i/%i", r.num, r.den);
-      if (widths[col] < w) widths[col] = w;
+// Make room for at least `rows` rows of `cols` cells, at least doubling any
+// dimension that has to grow.
+static void linprog_reserve(linprog *lp, size_t rows, size_t cols) {
+  rational **coeff;
+  rational *cells;
+  size_t y, i;
+
+  if (rows <= lp->height && cols <= lp->width) return;
+  if (rows < lp->height) rows = lp->height;
+  if (rows > lp->height && rows < 2 * lp->height) rows = 2 * lp->height;
+  if (cols < lp->width) cols = lp->width;
+  if (cols > lp->width && cols < 2 * lp->width) cols = 2 * lp->width;
+
+  coeff = malloc(rows * sizeof(*coeff));
+  cells = malloc(rows * cols * sizeof(*cells));
+  if (!coeff || !cells) abort();
+
+  for (i = 0; i < rows * cols; i++) {
+    cells[i] = (rational){0, 1};
+  }
+  for (y = 0; y < rows; y++) {
+    coeff[y] = cells + y * cols;
+    if (y < lp->height) {
+      memcpy(coeff[y], lp->coeff[y], lp->width * sizeof(*cells));
     }
   }
 
-  for (col = 0; col < lp->variables; col++) {
-    printf(" %*zu |", widths[col], col);
-  }
-  printf(" RHS\n");
+  free(lp->coeff);
+  free(lp->cells);
+  lp->coeff = coeff;
+  lp->cells = cells;
+  lp->height = rows;
+  lp->width = cols;
+}
 
-  for (row = 0; row <= lp->conditions; row++) {
-    for (col = 0; col <= lp->variables; col++) {
-      if (col) printf("|");
-      r = lp->coeff[row][col];
-      snprintf(buffer, sizeof(buffer), "%i/%i", r.num, r.den);
-      printf(" %*s ", widths[col], buffer);
-    }
-    printf("\n");
-  }
-  printf("\n");
+static void linprog_free(linprog *lp) {
+  free(lp->coeff);
+  free(lp->cells);
+  memset(lp, 0, sizeof(*lp));
 }
 
-void linprog_ero_scale(linprog *lp, size_t row, rational scalar) {
+static void linprog_ero_scale(linprog *lp, size_t row, rational scalar) {
   size_t col;
   for (col = 0; col <= lp->variables; col++) {
     rational_muleq(&lp->coeff[row][col], scalar);
   }
 }
 
-void linprog_ero_add(linprog *lp, size_t src, size_t dst, rational scalar) {
+static void linprog_ero_add(
+  linprog *lp,
+  size_t src,
+  size_t dst,
+  rational scalar
+) {
   size_t col;
   rational temp;
 
@@ -310,13 +290,12 @@ void linprog_ero_add(linprog *lp, size_t src, size_t dst, rational scalar) {
   }
 }
 
-void linprog_new_constraint(linprog *lp) {
+static void linprog_new_constraint(linprog *lp) {
   size_t row, col;
   rational *src, *dst;
   rational zero = {0, 1};
 
-  assert(lp->conditions + 2 < MAX_CONDITIONS);
-  assert(lp->variables + 2 < MAX_VARIABLES);
+  linprog_reserve(lp, lp->conditions + 2, lp->variables + 2);
 
   for (row = 0; row <= lp->conditions; row++) {
     dst = &lp->coeff[row][lp->variables + 1];
@@ -335,7 +314,7 @@ void linprog_new_constraint(linprog *lp) {
   lp->conditions++;
 }
 
-void linprog_pivot(linprog *lp, size_t col, size_t row) {
+static void linprog_pivot(linprog *lp, size_t col, size_t row) {
   size_t y;
   rational scalar;
 
@@ -352,7 +331,7 @@ void linprog_pivot(linprog *lp, size_t col, size_t row) {
   }
 }
 
-bool linprog_optimal(linprog *lp) {
+static bool linprog_optimal(linprog *lp) {
   size_t x;
   rational objective;
 
@@ -366,7 +345,7 @@ bool linprog_optimal(linprog *lp) {
   return true;
 }
 
-size_t linprog_select_pivot_col(linprog *lp) {
+static size_t linprog_select_pivot_col(linprog *lp) {
   size_t col, best_index = 0;
   rational *objective = lp->coeff[lp->conditions];
   rational best_value = objective[best_index];
@@ -381,9 +360,9 @@ size_t linprog_select_pivot_col(linprog *lp) {
   return best_index;
 }
 
-size_t linprog_select_pivot_row(linprog *lp, size_t col) {
+static size_t linprog_select_pivot_row(linprog *lp, size_t col) {
   size_t y, best;
-  rational best_value = {INT32_MAX, 1};
+  rational best_value = {INT64_MAX, 1};
   rational value;
 
   for (y = 0; y < lp->conditions; y++) {
@@ -396,12 +375,12 @@ size_t linprog_select_pivot_row(linprog *lp, size_t col) {
     }
   }
 
-  assert(best_value.num != INT32_MAX);
+  assert(best_value.num != INT64_MAX);
 
   return best;
 }
 
-size_t linprog_select_cutting_row(linprog *lp) {
+static size_t linprog_select_cutting_row(linprog *lp) {
   size_t y;
   rational constant;
 
@@ -413,7 +392,7 @@ size_t linprog_select_cutting_row(linprog *lp) {
   return y;
 }
 
-size_t linprog_select_cutting_col(linprog *lp, size_t row) {
+static size_t linprog_select_cutting_col(linprog *lp, size_t row) {
   size_t col, bestidx;
   rational val, bestval;
   rational *objective = lp->coeff[lp->conditions];
@@ -438,7 +417,7 @@ size_t linprog_select_cutting_col(linprog *lp, size_t row) {
   return bestidx;
 }
 
-uint64_t linprog_solve(linprog *lp) {
+static uint64_t linprog_solve(linprog *lp) {
   size_t row, col, newrow, newcol;
   rational r;
 
@@ -476,18 +455,14 @@ uint64_t linprog_solve(linprog *lp) {
   return lp->coeff[lp->conditions][lp->variables].num;
 }
 
-void linprog_init(linprog *lp, iterator const *iter) {
+static void linprog_init(linprog *lp, iterator const *iter) {
   size_t y, x;
 
   memset(lp, 0, sizeof(linprog));
-  for (y = 0; y < MAX_CONDITIONS; y++) {
-    for (x = 0; x < MAX_VARIABLES; x++) {
-      lp->coeff[y][x].den = 1;
-    }
-  }
 
   lp->variables = iter->targets + iter->nbuttons;
   lp->conditions = iter->targets;
+  linprog_reserve(lp, lp->conditions + 1, lp->variables + 1);
 
   // Set the coefficients of the variables (including the objective function)
   // Each 'button' from the input is a decision variable; the coefficients
@@ -519,52 +494,113 @@ void linprog_init(linprog *lp, iterator const *iter) {
   }
 }
 
-void part1(char const *input) {
-  iterator iter = {input};
-  uint64_t total = 0;
-  uint64_t src, dst;
-  size_t i;
-
-  aoc_array dists = {0};
-  aoc_array stack = {0};
-
-  while (next(&iter)) {
-    // Initialize the distances to the target to the max value (except the
-    // target itself, which has a distance of 0).
-    dists.count = (1 << iter.targets);
-    aoc_array_ensure_capacity(&dists, dists.count);
-    memset(dists.items, 0xff, sizeof(*dists.items) * dists.count);
-    dists.items[iter.indicators] = 0;
-
-    aoc_array_push(&stack, iter.indicators);
-    while (aoc_array_pop(&stack, &src)) {
-      for (i = 0; i < iter.nbuttons; i++) {
-        dst = src ^ iter.buttons[i];
-        if (dists.items[dst] > dists.items[src] + 1) {
-          dists.items[dst] = dists.items[src] + 1;
-          aoc_array_push(&stack, dst);
-        }
+// Find the fewest button presses that light up the machine's indicators with a
+// breadth-first search over all 2^targets light patterns. The search state
+// lives on the stack so that machines can be solved on any thread.
+static uint64_t indicator_presses(iterator const *iter) {
+  uint16_t dists[1 << MAX_TARGETS];
+  uint16_t queue[1 << MAX_TARGETS];
+  size_t head = 0, tail = 0, i;
+  uint16_t src, dst;
+
+  // Initialize the distances to the target to the max value (except the
+  // target itself, which has a distance of 0).
+  memset(dists, 0xff, sizeof(*dists) * (1 << iter->targets));
+  dists[iter->indicators] = 0;
+
+  aoc_trace_begin("search");
+  queue[tail++] = iter->indicators;
+  while (head < tail && dists[0] == UINT16_MAX) {
+    src = queue[head++];
+    for (i = 0; i < iter->nbuttons; i++) {
+      dst = src ^ iter->buttons[i];
+      if (dists[dst] == UINT16_MAX) {
+        dists[dst] = dists[src] + 1;
+        queue[tail++] = dst;
       }
     }
-
-    total += dists.items[0];
   }
+  aoc_trace_end();
+
+  return dists[0] == UINT16_MAX ? UINT64_MAX : dists[0];
+}
 
-  printf("%" PRIu64 "\n", total);
+static uint64_t joltage_presses(iterator const *iter) {
+  linprog lp;
+  uint64_t presses;
+
+  aoc_trace_begin("init");
+  linprog_init(&lp, iter);
+  aoc_trace_end();
+
+  aoc_trace_begin("solve");
+  presses = linprog_solve(&lp);
+  aoc_trace_end();
+
+  linprog_free(&lp);
 
-  aoc_array_free(&dists);
-  aoc_array_free(&stack);
+  return presses;
+}
+
+static bool map_indicators(void *ctx, char const **input, uint64_t *value) {
+  iterator iter = {*input};
+
+  (void)ctx;
+  if (!next(&iter)) return false;
+  *value = indicator_presses(&iter);
+  aoc_parse_space(&iter.input);
+  *input = iter.input;
+  return true;
 }
 
-void part2(char const *input) {
-  iterator iter = {input};
+static bool map_joltages(void *ctx, char const **input, uint64_t *value) {
+  iterator iter = {*input};
+
+  (void)ctx;
+  if (!next(&iter)) return false;
+  *value = joltage_presses(&iter);
+  aoc_parse_space(&iter.input);
+  *input = iter.input;
+  return true;
+}
+
+// Machines are independent, so they are solved in parallel and summed.
+uint64_t part1(char const *input) {
+  aoc_mapreduce mr = {.map = map_indicators};
+  return aoc_mapreduce_run(&mr, input, strlen(input));
+}
+
+uint64_t part2(char const *input) {
+  aoc_mapreduce mr = {.map = map_joltages};
+  return aoc_mapreduce_run(&mr, input, strlen(input));
+}
+
+// Machines are independent, so the streaming entry points parse and solve one
+// line at a time.
+uint64_t stream1(aoc_stream *stream) {
+  iterator iter;
   uint64_t total = 0;
-  linprog lp;
+  size_t length;
+  char *line;
+
+  while ((line = aoc_stream_next(stream, '\n', &length))) {
+    iter.input = line;
+    if (next(&iter)) total += indicator_presses(&iter);
+  }
+
+  return total;
+}
+
+uint64_t stream2(aoc_stream *stream) {
+  iterator iter;
+  uint64_t total = 0;
+  size_t length;
+  char *line;
 
-  while (next(&iter)) {
-    linprog_init(&lp, &iter);
-    total += linprog_solve(&lp);
+  while ((line = aoc_stream_next(stream, '\n', &length))) {
+    iter.input = line;
+    if (next(&iter)) total += joltage_presses(&iter);
   }
 
-  printf("%" PRIu64 "\n", total);
+  return total;
 }
@@ -7,13 +7,16 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <aoc-array.h>
+#include <aoc-trace.h>
+
 #define MAXIDS (26 * 26 * 26)
 
 typedef struct iterator {
   char const *input;
 } iterator;
 
-uint16_t id_from_text(char const text[3]) {
+static uint16_t id_from_text(char const text[3]) {
   uint16_t id = 0;
   assert('a' <= text[0] && text[0] <= 'z');
   assert('a' <= text[1] && text[1] <= 'z');
@@ -26,7 +29,7 @@ uint16_t id_from_text(char const text[3]) {
   return id;
 }
 
-bool nextsrc(iterator *it, uint16_t *id) {
+static bool nextsrc(iterator *it, uint16_t *id) {
   while (isspace(*it->input)) {
     it->input++;
   }
@@ -44,7 +47,7 @@ bool nextsrc(iterator *it, uint16_t *id) {
   return true;
 }
 
-bool nextdst(iterator *it, uint16_t *id) {
+static bool nextdst(iterator *it, uint16_t *id) {
   while (*it->input == ' ') {
     it->input++;
   }
@@ -64,65 +67,50 @@ typedef struct slice {
   size_t end;
 } slice;
 
+AOC_ARRAY_STATIC(id_list, uint16_t)
+
 typedef struct graph {
   slice *slices;
-  uint16_t *dsts;
-  size_t count;
-  size_t capacity;
+  id_list dsts;
 } graph;
 
-void graph_init(graph *self) {
+static void graph_init(graph *self) {
   memset(self, 0, sizeof(*self));
 
   self->slices = malloc(MAXIDS * sizeof(slice));
   memset(self->slices, 0xff, MAXIDS * sizeof(slice));
 }
 
-void graph_free(graph *self) {
+static void graph_free(graph *self) {
   free(self->slices);
-  free(self->dsts);
+  id_list_free(&self->dsts);
   memset(self, 0, sizeof(*self));
 }
 
-void graph_ensure_capacity(graph *self, size_t target) {
-  size_t capacity;
-  uint16_t *items;
-
-  if (self->capacity < target) {
-    for (capacity = 1; capacity < target; capacity *= 2) {}
-
-    items = realloc(self->dsts, capacity * sizeof(*items));
-    if (!items) abort();
-
-    self->dsts = items;
-    self->capacity = capacity;
-  }
-}
-
-void graph_new_src(graph *self, uint16_t src) {
+static void graph_new_src(graph *self, uint16_t src) {
   assert(self->slices[src].begin == SIZE_MAX);
-  self->slices[src].begin = self->count;
-  self->slices[src].end = self->count;
+  self->slices[src].begin = self->dsts.count;
+  self->slices[src].end = self->dsts.count;
 }
 
-void graph_add_dst(graph *self, uint16_t src, uint16_t dst) {
-  assert(self->slices[src].end == self->count);
-  graph_ensure_capacity(self, self->count + 1);
-
-  self->dsts[self->count++] = dst;
+static void graph_add_dst(graph *self, uint16_t src, uint16_t dst) {
+  assert(self->slices[src].end == self->dsts.count);
+  id_list_push(&self->dsts, dst);
   self->slices[src].end++;
 }
 
-void graph_populate(graph *self, char const *input) {
+static void graph_populate(graph *self, char const *input) {
   iterator it = {input};
   uint16_t src, dst;
 
+  aoc_trace_begin("populate");
   while (nextsrc(&it, &src)) {
     graph_new_src(self, src);
     while (nextdst(&it, &dst)) {
       graph_add_dst(self, src, dst);
     }
   }
+  aoc_trace_end();
 }
 
 typedef struct frame {
@@ -130,13 +118,14 @@ typedef struct frame {
   slice dsts;
 } frame;
 
-uint64_t graph_paths(graph *g, char const *origin, char const *target) {
+static uint64_t graph_paths(graph *g, char const *origin, char const *target) {
   frame *stack, top;
   size_t nstack;
   uint64_t *paths, total;
   uint16_t oid = id_from_text(origin);
   uint16_t tid = id_from_text(target);
 
+  aoc_trace_begin("paths");
   paths = malloc(MAXIDS * sizeof(*paths));
   memset(paths, 0xff, MAXIDS * sizeof(*paths));
   paths[tid] = 1;
@@ -153,16 +142,16 @@ uint64_t graph_paths(graph *g, char const *origin, char const *target) {
     if (top.dsts.begin == top.dsts.end) {
       // If there are no more destinations for the current node, pop it.
       nstack--;
-    } else if (paths[g->dsts[top.dsts.begin]] == UINT64_MAX) {
+    } else if (paths[g->dsts.items[top.dsts.begin]] == UINT64_MAX) {
       // If the current destination HAS NOT been visited, visit it.
-      paths[g->dsts[top.dsts.begin]] = 0;
-      stack[nstack].src = g->dsts[top.dsts.begin];
-      stack[nstack].dsts = g->slices[g->dsts[top.dsts.begin]];
+      paths[g->dsts.items[top.dsts.begin]] = 0;
+      stack[nstack].src = g->dsts.items[top.dsts.begin];
+      stack[nstack].dsts = g->slices[g->dsts.items[top.dsts.begin]];
       nstack++;
     } else {
       // If the current destination HAS been visited, add its number of paths to
       // the current node's, then move on to the next destination.
-      paths[top.src] += paths[g->dsts[top.dsts.begin]];
+      paths[top.src] += paths[g->dsts.items[top.dsts.begin]];
       stack[nstack - 1].dsts.begin++;
     }
   }
@@ -170,10 +159,12 @@ uint64_t graph_paths(graph *g, char const *origin, char const *target) {
   total = paths[oid];
   free(stack);
   free(paths);
+  aoc_trace_end();
+
   return total;
 }
 
-void part1(char const *input) {
+uint64_t part1(char const *input) {
   graph g;
   uint64_t total;
 
@@ -181,12 +172,12 @@ void part1(char const *input) {
   graph_populate(&g, input);
 
   total = graph_paths(&g, "you", "out");
-  printf("%" PRIu64 "\n", total);
 
   graph_free(&g);
+  return total;
 }
 
-void part2(char const *input) {
+uint64_t part2(char const *input) {
   graph g;
   uint64_t total;
   uint64_t svr_fst, fst_snd, snd_out;
@@ -220,7 +211,7 @@ void part2(char const *input) {
   // earlier logic again to go from dac to out.
 
   total = svr_fst * fst_snd * snd_out;
-  printf("%" PRIu64 "\n", total);
 
   graph_free(&g);
+  return total;
 }
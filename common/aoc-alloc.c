@@ -0,0 +1,118 @@
+#include "aoc-alloc.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stddef.h>
+
+#include <malloc.h>
+
+// The allocator entry points below replace the C library's own (which glibc
+// explicitly supports) and forward to its implementation. Because they replace
+// the symbols outright, allocations made inside the C library, such as by
+// strdup, are recorded as well.
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t align, size_t size);
+void __libc_free(void *ptr);
+
+static _Thread_local aoc_alloc_stats *aoc_alloc_scope;
+
+aoc_alloc_stats *aoc_alloc_track(aoc_alloc_stats *stats) {
+  aoc_alloc_stats *prev = aoc_alloc_scope;
+  aoc_alloc_scope = stats;
+  return prev;
+}
+
+aoc_alloc_stats *aoc_alloc_current(void) {
+  return aoc_alloc_scope;
+}
+
+static void aoc_alloc_record(aoc_alloc_stats *stats, void *ptr) {
+  int_fast64_t size, live, peak;
+
+  if (!ptr) return;
+
+  size = (int_fast64_t)malloc_usable_size(ptr);
+  atomic_fetch_add(&stats->allocs, 1);
+  atomic_fetch_add(&stats->bytes, (uint_fast64_t)size);
+
+  live = atomic_fetch_add(&stats->live, size) + size;
+  peak = atomic_load(&stats->peak);
+  while (live > peak) {
+    if (atomic_compare_exchange_weak(&stats->peak, &peak, live)) break;
+  }
+}
+
+// Record the free of a block whose usable size was `size`.
+static void aoc_alloc_forget(aoc_alloc_stats *stats, size_t size) {
+  atomic_fetch_add(&stats->frees, 1);
+  atomic_fetch_sub(&stats->live, (int_fast64_t)size);
+}
+
+void *malloc(size_t size) {
+  void *ptr = __libc_malloc(size);
+  if (aoc_alloc_scope) aoc_alloc_record(aoc_alloc_scope, ptr);
+  return ptr;
+}
+
+void *calloc(size_t count, size_t size) {
+  void *ptr = __libc_calloc(count, size);
+  if (aoc_alloc_scope) aoc_alloc_record(aoc_alloc_scope, ptr);
+  return ptr;
+}
+
+void *realloc(void *ptr, size_t size) {
+  size_t old;
+  void *newptr;
+
+  if (!aoc_alloc_scope) return __libc_realloc(ptr, size);
+
+  // A realloc is recorded as a free of the old block and an allocation of the
+  // new one, since either may move. The old size has to be read first, since
+  // the old block is gone afterwards. A failed realloc leaves the old block
+  // alone, but a realloc to zero bytes frees it and returns NULL.
+  old = ptr ? malloc_usable_size(ptr) : 0;
+  newptr = __libc_realloc(ptr, size);
+  if (!newptr && size != 0) return NULL;
+
+  if (ptr) aoc_alloc_forget(aoc_alloc_scope, old);
+  aoc_alloc_record(aoc_alloc_scope, newptr);
+  return newptr;
+}
+
+void *aligned_alloc(size_t align, size_t size) {
+  void *ptr = __libc_memalign(align, size);
+  if (aoc_alloc_scope) aoc_alloc_record(aoc_alloc_scope, ptr);
+  return ptr;
+}
+
+int posix_memalign(void **out, size_t align, size_t size) {
+  void *ptr;
+
+  if (align < sizeof(void *) || (align & (align - 1))) return EINVAL;
+  if (!(ptr = __libc_memalign(align, size))) return ENOMEM;
+  if (aoc_alloc_scope) aoc_alloc_record(aoc_alloc_scope, ptr);
+
+  *out = ptr;
+  return 0;
+}
+
+void free(void *ptr) {
+  if (aoc_alloc_scope && ptr) {
+    aoc_alloc_forget(aoc_alloc_scope, malloc_usable_size(ptr));
+  }
+  __libc_free(ptr);
+}
+
+void aoc_alloc_print(FILE *file, aoc_alloc_stats *stats, uint64_t runs) {
+  uint64_t allocs = atomic_load(&stats->allocs);
+  uint64_t frees = atomic_load(&stats->frees);
+  uint64_t bytes = atomic_load(&stats->bytes);
+  int64_t peak = atomic_load(&stats->peak);
+
+  fprintf(file, "  %-16s%16" PRIu64 "\n", "allocations", allocs / runs);
+  fprintf(file, "  %-16s%16" PRIu64 "\n", "frees", frees / runs);
+  fprintf(file, "  %-16s%16" PRIu64 " bytes\n", "allocated", bytes / runs);
+  fprintf(file, "  %-16s%16" PRId64 " bytes\n", "peak live", peak);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Allocation counters for one tracked scope. The fields are updated
+// atomically, so one set of counters can be shared by every thread that works
+// on behalf of the same part.
+typedef struct aoc_alloc_stats {
+  atomic_uint_fast64_t allocs;
+  atomic_uint_fast64_t frees;
+  atomic_uint_fast64_t bytes;
+  atomic_int_fast64_t live;
+  atomic_int_fast64_t peak;
+} aoc_alloc_stats;
+
+// Record every malloc/calloc/realloc/aligned allocation and free made on the
+// calling thread in `stats` (or stop recording if `stats` is NULL). Returns
+// the previously tracked stats. Threads started through `aoc_parallel`
+// inherit the tracked stats of the thread that started them.
+//
+// Sizes are the usable sizes reported by the allocator, which include its
+// rounding. Freeing memory that was allocated before tracking started lowers
+// the live byte count below what the tracked code itself holds.
+aoc_alloc_stats *aoc_alloc_track(aoc_alloc_stats *stats);
+
+// Return the stats tracked on the calling thread, if any.
+aoc_alloc_stats *aoc_alloc_current(void);
+
+// Print the counters averaged over `runs`. The peak is not averaged: across
+// runs that free everything they allocate it is the peak of the largest run.
+void aoc_alloc_print(FILE *file, aoc_alloc_stats *stats, uint64_t runs);
@@ -0,0 +1,75 @@
+#include "aoc-arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct aoc_arena_chunk {
+  aoc_arena_chunk *prev;
+  size_t size;
+};
+
+static void aoc_arena_grow(aoc_arena *self, size_t need) {
+  size_t size = AOC_ARENA_CHUNK;
+  aoc_arena_chunk *chunk;
+
+  if (self->chunk) size = self->chunk->size * 2;
+  if (size > AOC_ARENA_MAX_CHUNK) size = AOC_ARENA_MAX_CHUNK;
+  if (size < need) size = need;
+
+  if (!(chunk = malloc(sizeof(*chunk) + size))) abort();
+  chunk->prev = self->chunk;
+  chunk->size = size;
+
+  self->chunk = chunk;
+  self->next = (char *)(chunk + 1);
+  self->end = self->next + size;
+}
+
+void *aoc_arena_alloc(aoc_arena *self, size_t size, size_t align) {
+  uintptr_t next = (uintptr_t)self->next;
+  uintptr_t start = (next + align - 1) & ~(uintptr_t)(align - 1);
+
+  if (!self->next || start + size > (uintptr_t)self->end) {
+    // A fresh chunk starts suitably aligned for anything malloc returns, but
+    // stricter alignments may need some padding.
+    aoc_arena_grow(self, size + align);
+    next = (uintptr_t)self->next;
+    start = (next + align - 1) & ~(uintptr_t)(align - 1);
+  }
+
+  self->next = (char *)(start + size);
+  return (void *)start;
+}
+
+void *aoc_arena_zalloc(aoc_arena *self, size_t size, size_t align) {
+  void *data = aoc_arena_alloc(self, size, align);
+  memset(data, 0, size);
+  return data;
+}
+
+void aoc_arena_reset(aoc_arena *self) {
+  aoc_arena_chunk *chunk, *prev;
+
+  if (!self->chunk) return;
+
+  for (chunk = self->chunk->prev; chunk; chunk = prev) {
+    prev = chunk->prev;
+    free(chunk);
+  }
+
+  self->chunk->prev = NULL;
+  self->next = (char *)(self->chunk + 1);
+  self->end = self->next + self->chunk->size;
+}
+
+void aoc_arena_free(aoc_arena *self) {
+  aoc_arena_chunk *chunk, *prev;
+
+  for (chunk = self->chunk; chunk; chunk = prev) {
+    prev = chunk->prev;
+    free(chunk);
+  }
+
+  memset(self, 0, sizeof(*self));
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stddef.h>
+
+// Size of the first chunk an arena allocates. Later chunks double in size up
+// to AOC_ARENA_MAX_CHUNK, unless a single allocation needs more.
+#define AOC_ARENA_CHUNK (64 * 1024)
+#define AOC_ARENA_MAX_CHUNK (4 * 1024 * 1024)
+
+typedef struct aoc_arena_chunk aoc_arena_chunk;
+
+// A bump allocator. Allocations are carved out of large chunks in order and
+// are never freed individually; instead the whole arena is reset or freed at
+// once. A zeroed arena is empty and ready to use.
+typedef struct aoc_arena {
+  aoc_arena_chunk *chunk;
+  char *next;
+  char *end;
+} aoc_arena;
+
+// Allocate `size` bytes aligned to `align`, which must be a power of two.
+// Aborts if out of memory.
+void *aoc_arena_alloc(aoc_arena *self, size_t size, size_t align);
+
+// Allocate one zeroed `type` from `arena`.
+#define aoc_arena_new(arena, type)                                             \
+  ((type *)aoc_arena_zalloc((arena), sizeof(type), _Alignof(type)))
+
+void *aoc_arena_zalloc(aoc_arena *self, size_t size, size_t align);
+
+// Release every allocation at once, keeping the most recent chunk so that the
+// arena can be refilled without going back to malloc.
+void aoc_arena_reset(aoc_arena *self);
+
+void aoc_arena_free(aoc_arena *self);
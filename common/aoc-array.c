@@ -3,96 +3,88 @@
 #include <stdlib.h>
 #include <string.h>
 
-void aoc_array_ensure_capacity(aoc_array *self, size_t target) {
-  size_t newcap, newsize;
-  uint64_t *newitems;
+void *aoc_array_alloc(size_t size) {
+  void *items;
 
-  if (target > self->capacity) {
-    newcap = self->capacity ? self->capacity : 16;
-    for (; newcap < target; newcap *= 2) {}
+  size = (size + AOC_ARRAY_ALIGN - 1) & ~(size_t)(AOC_ARRAY_ALIGN - 1);
+  if (!(items = aligned_alloc(AOC_ARRAY_ALIGN, size))) abort();
 
-    newsize = sizeof(uint64_t) * newcap;
-    newitems = realloc(self->items, newsize);
-    if (!newitems) abort();
-
-    self->capacity = newcap;
-    self->items = newitems;
-  }
+  return items;
 }
 
-void aoc_array_append(aoc_array *self, uint64_t const *vals, size_t count) {
-  aoc_array_ensure_capacity(self, self->count + count);
-  memcpy(&self->items[self->count], vals, sizeof(uint64_t) * count);
-  self->count += count;
-}
+AOC_ARRAY_DEFINE(aoc_array, uint64_t)
 
-void aoc_array_push(aoc_array *self, uint64_t val) {
-  aoc_array_append(self, &val, 1);
-}
+// Arrays shorter than this are insertion sorted instead of radix sorted.
+#define AOC_ARRAY_SORT_SMALL (64)
+#define AOC_ARRAY_RADIX (256)
 
-bool aoc_array_pop(aoc_array *self, uint64_t *val) {
-  if (self->count == 0) return false;
-  *val = self->items[--self->count];
-  return true;
-}
+static void aoc_array_insertion_sort(uint64_t *items, size_t count) {
+  size_t i, j;
+  uint64_t item;
 
-bool aoc_array_top(aoc_array *self, uint64_t *val) {
-  if (self->count == 0) return false;
-  *val = self->items[self->count - 1];
-  return true;
+  for (i = 1; i < count; i++) {
+    item = items[i];
+    for (j = i; j > 0 && items[j - 1] > item; j--) {
+      items[j] = items[j - 1];
+    }
+    items[j] = item;
+  }
 }
 
-static void aoc_array_swapelems(aoc_array *self, size_t i, size_t j) {
-  uint64_t temp = self->items[i];
-  self->items[i] = self->items[j];
-  self->items[j] = temp;
-}
+// Sort with an LSD radix sort, one byte per pass. Every histogram is gathered
+// in a single read of the input, and passes over bytes that are the same in
+// every item are skipped, so small keys only pay for the bytes they use.
+static void aoc_array_radix_sort(uint64_t *items, size_t count) {
+  size_t (*counts)[AOC_ARRAY_RADIX];
+  uint64_t *src = items, *dst, *temp;
+  size_t i, pass, sum, offset;
+  uint64_t item;
+
+  if (!(counts = calloc(8, sizeof(*counts)))) abort();
+  dst = aoc_array_alloc(count * sizeof(*items));
+
+  for (i = 0; i < count; i++) {
+    item = items[i];
+    for (pass = 0; pass < 8; pass++) {
+      counts[pass][(item >> (pass * 8)) & 0xff]++;
+    }
+  }
 
-static void aoc_array_quicksort(aoc_array *self, size_t lo, size_t hi) {
-  size_t i, j;
-  uint64_t pivot;
+  for (pass = 0; pass < 8; pass++) {
+    if (counts[pass][(items[0] >> (pass * 8)) & 0xff] == count) continue;
 
-  if (lo >= hi || hi >= self->count) return;
+    for (i = 0, sum = 0; i < AOC_ARRAY_RADIX; i++) {
+      offset = counts[pass][i];
+      counts[pass][i] = sum;
+      sum += offset;
+    }
 
-  pivot = self->items[hi];
-  for (i = j = lo; j < hi; j++) {
-    if (self->items[j] <= pivot) {
-      aoc_array_swapelems(self, i, j);
-      i++;
+    for (i = 0; i < count; i++) {
+      item = src[i];
+      dst[counts[pass][(item >> (pass * 8)) & 0xff]++] = item;
     }
+
+    temp = src;
+    src = dst;
+    dst = temp;
+  }
+
+  // After an odd number of passes the sorted items are in the scratch buffer.
+  if (src != items) {
+    memcpy(items, src, count * sizeof(*items));
+    dst = src;
   }
-  aoc_array_swapelems(self, i, hi);
 
-  aoc_array_quicksort(self, lo, i - 1);
-  aoc_array_quicksort(self, i + 1, hi);
+  free(dst);
+  free(counts);
 }
 
 void aoc_array_sort(aoc_array *self) {
   if (self->count < 2) return;
-  aoc_array_quicksort(self, 0, self->count - 1);
-}
-
-void aoc_array_free(aoc_array *self) {
-  free(self->items);
-  *self = (aoc_array){0};
-}
 
-aoc_array aoc_array_copy(aoc_array const *self) {
-  aoc_array copy;
-  size_t size = self->count * sizeof(*self->items);
-
-  copy.count = self->count;
-  copy.items = malloc(size);
-  if (!copy.items) abort();
-
-  memcpy(copy.items, self->items, size);
-  copy.capacity = copy.count;
-
-  return copy;
-}
-
-aoc_array aoc_array_move(aoc_array *self) {
-  aoc_array temp = *self;
-  memset(self, 0, sizeof(*self));
-  return temp;
+  if (self->count < AOC_ARRAY_SORT_SMALL) {
+    aoc_array_insertion_sort(self->items, self->count);
+  } else {
+    aoc_array_radix_sort(self->items, self->count);
+  }
 }
@@ -3,27 +3,137 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
-typedef struct aoc_array {
-  uint64_t *items;
-  uint32_t count;
-  uint32_t capacity;
-} aoc_array;
+// Storage for every array is aligned to (and sized in multiples of) this many
+// bytes, so that kernels can use aligned vector loads on any array.
+#define AOC_ARRAY_ALIGN (64)
 
-void aoc_array_ensure_capacity(aoc_array *self, size_t target);
+// Declare `name` as a growable array of `type`, along with prototypes for its
+// functions:
+//
+//   ensure_capacity  grow the storage to hold at least `target` items
+//   append           copy `count` items onto the end
+//   push, pop, top   use the array as a stack
+//   shrink           release any capacity beyond `count`
+//   copy             return a copy with its own storage
+//   move             return the array, leaving `self` empty
+//   free             release the storage
+//
+// Capacity doubles from 16 items when it runs out. Growing keeps everything up
+// to the old capacity, so it is fine to raise `count` first and grow after.
+#define AOC_ARRAY_DECLARE(name, type)                                          \
+  AOC_ARRAY_TYPE(name, type)                                                   \
+  AOC_ARRAY_PROTOTYPES(, name, type)
 
-void aoc_array_append(aoc_array *self, uint64_t const *vals, size_t count);
+// Define the functions of an array declared with AOC_ARRAY_DECLARE.
+#define AOC_ARRAY_DEFINE(name, type) AOC_ARRAY_FUNCTIONS(, name, type)
 
-void aoc_array_push(aoc_array *self, uint64_t val);
+// Declare and define an array type that is private to one source file.
+#define AOC_ARRAY_STATIC(name, type)                                           \
+  AOC_ARRAY_TYPE(name, type)                                                   \
+  AOC_ARRAY_FUNCTIONS(static inline, name, type)
 
-bool aoc_array_pop(aoc_array *self, uint64_t *val);
+#define AOC_ARRAY_TYPE(name, type)                                             \
+  typedef struct name {                                                        \
+    type *items;                                                               \
+    size_t count;                                                              \
+    size_t capacity;                                                           \
+  } name;
 
-bool aoc_array_top(aoc_array *self, uint64_t *val);
+#define AOC_ARRAY_PROTOTYPES(scope, name, type)                                \
+  scope void name##_ensure_capacity(name *self, size_t target);                \
+  scope void name##_append(name *self, type const *vals, size_t count);        \
+  scope void name##_push(name *self, type val);                                \
+  scope bool name##_pop(name *self, type *val);                                \
+  scope bool name##_top(name *self, type *val);                                \
+  scope void name##_shrink(name *self);                                        \
+  scope name name##_copy(name const *self);                                    \
+  scope name name##_move(name *self);                                          \
+  scope void name##_free(name *self);
 
-void aoc_array_sort(aoc_array *self);
+#define AOC_ARRAY_FUNCTIONS(scope, name, type)                                 \
+  scope void name##_ensure_capacity(name *self, size_t target) {               \
+    size_t capacity;                                                           \
+    type *items;                                                               \
+                                                                               \
+    if (target > self->capacity) {                                             \
+      capacity = self->capacity ? self->capacity : 16;                         \
+      for (; capacity < target; capacity *= 2) {}                              \
+                                                                               \
+      items = aoc_array_alloc(capacity * sizeof(type));                        \
+      if (self->items) {                                                       \
+        memcpy(items, self->items, self->capacity * sizeof(type));             \
+      }                                                                        \
+      free(self->items);                                                       \
+                                                                               \
+      self->items = items;                                                     \
+      self->capacity = capacity;                                               \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  scope void name##_append(name *self, type const *vals, size_t count) {       \
+    if (count == 0) return;                                                    \
+    name##_ensure_capacity(self, self->count + count);                         \
+    memcpy(&self->items[self->count], vals, count * sizeof(type));             \
+    self->count += count;                                                      \
+  }                                                                            \
+                                                                               \
+  scope void name##_push(name *self, type val) {                               \
+    name##_ensure_capacity(self, self->count + 1);                             \
+    self->items[self->count++] = val;                                          \
+  }                                                                            \
+                                                                               \
+  scope bool name##_pop(name *self, type *val) {                               \
+    if (self->count == 0) return false;                                        \
+    *val = self->items[--self->count];                                         \
+    return true;                                                               \
+  }                                                                            \
+                                                                               \
+  scope bool name##_top(name *self, type *val) {                               \
+    if (self->count == 0) return false;                                        \
+    *val = self->items[self->count - 1];                                       \
+    return true;                                                               \
+  }                                                                            \
+                                                                               \
+  scope void name##_shrink(name *self) {                                       \
+    type *items = NULL;                                                        \
+                                                                               \
+    if (self->count == self->capacity) return;                                 \
+    if (self->count) {                                                         \
+      items = aoc_array_alloc(self->count * sizeof(type));                     \
+      memcpy(items, self->items, self->count * sizeof(type));                  \
+    }                                                                          \
+    free(self->items);                                                         \
+                                                                               \
+    self->items = items;                                                       \
+    self->capacity = self->count;                                              \
+  }                                                                            \
+                                                                               \
+  scope name name##_copy(name const *self) {                                   \
+    name copy = {0};                                                           \
+    name##_append(&copy, self->items, self->count);                            \
+    return copy;                                                               \
+  }                                                                            \
+                                                                               \
+  scope name name##_move(name *self) {                                         \
+    name temp = *self;                                                         \
+    memset(self, 0, sizeof(*self));                                            \
+    return temp;                                                               \
+  }                                                                            \
+                                                                               \
+  scope void name##_free(name *self) {                                         \
+    free(self->items);                                                         \
+    memset(self, 0, sizeof(*self));                                            \
+  }
 
-void aoc_array_free(aoc_array *self);
+// Allocate `size` bytes aligned to AOC_ARRAY_ALIGN, rounding the size up to a
+// whole number of alignment units. Aborts if out of memory.
+void *aoc_array_alloc(size_t size);
 
-aoc_array aoc_array_copy(aoc_array const *self);
+AOC_ARRAY_DECLARE(aoc_array, uint64_t)
 
-aoc_array aoc_array_move(aoc_array *self);
+// Sort the items in ascending order. Large arrays are radix sorted, so this
+// takes linear time whatever the order of the input.
+void aoc_array_sort(aoc_array *self);
@@ -0,0 +1,12 @@
+#pragma once
+
+// An extra command a day provides on top of its parts, run by the day binary
+// as "[input] [name] [args]...". Days list their commands in a `commands`
+// array ending with an entry whose name is NULL.
+typedef struct aoc_command {
+  char const *name;
+  // The arguments the command takes, for the usage message.
+  char const *args;
+  // Run the command on the loaded `input`, returning the exit status.
+  int (*run)(char const *input, int argc, char **argv);
+} aoc_command;
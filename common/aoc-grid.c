@@ -0,0 +1,166 @@
+#include "aoc-grid.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Storage is allocated in whole cache lines.
+#define AOC_GRID_LINE (64)
+
+static void *aoc_grid_alloc(size_t *size) {
+  void *storage;
+
+  *size = (*size + AOC_GRID_LINE - 1) & ~(size_t)(AOC_GRID_LINE - 1);
+  if (!(storage = aligned_alloc(AOC_GRID_LINE, *size))) abort();
+
+  return storage;
+}
+
+// Measure the first row of `input`, then count the rest. A final row without a
+// newline still counts, but an empty one after the last newline does not.
+static void aoc_grid_measure(
+  char const *input,
+  size_t *width,
+  size_t *height
+) {
+  char const *line, *end;
+
+  for (end = input; *end != '\n' && *end != '\0'; end++) {}
+  *width = end - input;
+  if (*width > 0 && end[-1] == '\r') (*width)--;
+
+  *height = 0;
+  for (line = input; *line != '\0'; line = end + 1) {
+    (*height)++;
+    if (!(end = strchr(line, '\n'))) break;
+  }
+}
+
+// Return the row at `*line` and set `*length` to its length, without any
+// carriage return and at most `width`. Advances `*line` to the next row.
+static char const *aoc_grid_next_row(
+  char const **line,
+  size_t width,
+  size_t *length
+) {
+  char const *row = *line, *end;
+
+  for (end = row; *end != '\n' && *end != '\0'; end++) {}
+  *length = end - row;
+  if (*length > 0 && end[-1] == '\r') (*length)--;
+  if (*length > width) *length = width;
+
+  *line = *end ? end + 1 : end;
+  return row;
+}
+
+void aoc_grid_load(aoc_grid *self, char const *input, size_t pad, char fill) {
+  char const *line = input, *row;
+  size_t length, lead, y;
+
+  memset(self, 0, sizeof(*self));
+  aoc_grid_measure(input, &self->width, &self->height);
+
+  // The left border is widened to a whole alignment unit, so that every row
+  // starts aligned and not just the storage.
+  lead = (pad + AOC_GRID_ALIGN - 1) & ~(size_t)(AOC_GRID_ALIGN - 1);
+
+  self->pad = pad;
+  self->stride = lead + self->width + pad;
+  self->stride = (self->stride + AOC_GRID_ALIGN - 1) & ~(AOC_GRID_ALIGN - 1);
+  self->size = (self->height + 2 * pad) * self->stride;
+  self->storage = aoc_grid_alloc(&self->size);
+  self->data = self->storage + pad * self->stride + lead;
+  memset(self->storage, fill, self->size);
+
+  for (y = 0; y < self->height; y++) {
+    row = aoc_grid_next_row(&line, self->width, &length);
+    memcpy(aoc_grid_row(self, y), row, length);
+  }
+}
+
+void aoc_grid_free(aoc_grid *self) {
+  free(self->storage);
+  memset(self, 0, sizeof(*self));
+}
+
+// Allocate zeroed bit rows for a `width` by `height` grid.
+static void aoc_grid_bits_alloc(
+  aoc_grid_bits *self,
+  size_t width,
+  size_t height
+) {
+  memset(self, 0, sizeof(*self));
+
+  self->width = width;
+  self->height = height;
+  self->stride = (width + 63) / 64 + 1;
+
+  // One zero row above and below, plus the zero word that ends the last row.
+  self->size = ((self->height + 2) * self->stride + 1) * sizeof(uint64_t);
+  self->storage = aoc_grid_alloc(&self->size);
+  memset(self->storage, 0, self->size);
+  self->data = self->storage + self->stride + 1;
+}
+
+// Set the bits of `words` for the first `length` cells of `text` that equal
+// `cell`, 16 cells at a time where possible.
+static void aoc_grid_pack_row(
+  uint64_t *words,
+  char const *text,
+  size_t length,
+  char cell
+) {
+  size_t x = 0;
+
+#ifdef __SSE2__
+  __m128i match = _mm_set1_epi8(cell);
+  __m128i block;
+  uint64_t bits;
+
+  for (; x + 16 <= length; x += 16) {
+    block = _mm_loadu_si128((__m128i const *)(text + x));
+    bits = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, match));
+    words[x / 64] |= bits << (x % 64);
+  }
+#endif
+
+  for (; x < length; x++) {
+    words[x / 64] |= (uint64_t)(text[x] == cell) << (x % 64);
+  }
+}
+
+void aoc_grid_pack(aoc_grid_bits *self, aoc_grid const *grid, char cell) {
+  size_t y;
+
+  aoc_grid_bits_alloc(self, grid->width, grid->height);
+  for (y = 0; y < grid->height; y++) {
+    aoc_grid_pack_row(
+      aoc_grid_bits_row(self, y),
+      aoc_grid_row(grid, y),
+      grid->width,
+      cell
+    );
+  }
+}
+
+void aoc_grid_bits_load(aoc_grid_bits *self, char const *input, char cell) {
+  char const *line = input, *row;
+  size_t width, height, length, y;
+
+  aoc_grid_measure(input, &width, &height);
+  aoc_grid_bits_alloc(self, width, height);
+
+  for (y = 0; y < height; y++) {
+    row = aoc_grid_next_row(&line, width, &length);
+    aoc_grid_pack_row(aoc_grid_bits_row(self, y), row, length, cell);
+  }
+}
+
+void aoc_grid_bits_free(aoc_grid_bits *self) {
+  free(self->storage);
+  memset(self, 0, sizeof(*self));
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Every row of a grid starts at a multiple of this many bytes, so that row
+// loops can use aligned vector loads.
+#define AOC_GRID_ALIGN (16)
+
+// A copy of a rectangular text grid surrounded by a border of `pad` sentinel
+// cells on every side. Cells from (-pad, -pad) to (width + pad - 1, height +
+// pad - 1) can be read without bounds checks; everything outside the input
+// holds the fill character given when the grid was loaded. Rows shorter than
+// the first are filled out with it too.
+typedef struct aoc_grid {
+  // Cell (0, 0); cell (x, y) is data[x + y * stride].
+  char *data;
+  size_t width;
+  size_t height;
+  size_t stride;
+  size_t pad;
+  // The allocation backing the grid, border included.
+  char *storage;
+  size_t size;
+} aoc_grid;
+
+// Load the grid of newline-separated rows at `input`. Its width is the length
+// of the first row, ignoring any carriage return. Aborts if out of memory.
+void aoc_grid_load(aoc_grid *self, char const *input, size_t pad, char fill);
+
+void aoc_grid_free(aoc_grid *self);
+
+// Return a pointer to cell (0, y). Any y in [-pad, height + pad) is valid.
+static inline char *aoc_grid_row(aoc_grid const *self, ptrdiff_t y) {
+  return self->data + y * (ptrdiff_t)self->stride;
+}
+
+// A grid packed to one bit per cell, set where the cell matched. Bit x of row y
+// is bit x % 64 of row(y)[x / 64]. Every row is preceded and followed by a zero
+// word, and there is a zero row above and below the grid, so neighbours can be
+// found by shifting whole words without bounds checks.
+typedef struct aoc_grid_bits {
+  // The first word of row 0.
+  uint64_t *data;
+  size_t width;
+  size_t height;
+  // Words between rows, including one zero word.
+  size_t stride;
+  uint64_t *storage;
+  size_t size;
+} aoc_grid_bits;
+
+// Pack the cells of `grid` equal to `cell`. Aborts if out of memory.
+void aoc_grid_pack(aoc_grid_bits *self, aoc_grid const *grid, char cell);
+
+// Pack the cells equal to `cell` in the grid of newline-separated rows at
+// `input`, read the same way as aoc_grid_load but without making a copy of
+// the text first. Aborts if out of memory.
+void aoc_grid_bits_load(aoc_grid_bits *self, char const *input, char cell);
+
+void aoc_grid_bits_free(aoc_grid_bits *self);
+
+// Return a pointer to the first word of row `y`. Rows -1 and `height` are
+// all zero.
+static inline uint64_t *aoc_grid_bits_row(
+  aoc_grid_bits const *self,
+  ptrdiff_t y
+) {
+  return self->data + y * (ptrdiff_t)self->stride;
+}
@@ -0,0 +1,168 @@
+#include "aoc-input.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define READ_CHUNK (64 * 1024)
+
+static bool aoc_input_map(aoc_input *self, int fd, size_t length) {
+  size_t pagesize = (size_t)sysconf(_SC_PAGESIZE);
+  size_t mapped;
+  void *base, *file;
+
+  // Reserve enough zeroed pages to hold the file plus at least one byte past
+  // the end, then map the file over the front of the reservation. The tail of
+  // the last file page and any page after it read as zero, so the input is
+  // always NUL-terminated without copying it.
+  mapped = (length + pagesize) & ~(pagesize - 1);
+  base = mmap(NULL, mapped, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) return false;
+
+  file = mmap(base, length, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0);
+  if (file == MAP_FAILED) {
+    munmap(base, mapped);
+    return false;
+  }
+
+  madvise(base, length, MADV_SEQUENTIAL);
+
+  self->data = base;
+  self->length = length;
+  self->mapped = mapped;
+  return true;
+}
+
+static bool aoc_input_read(aoc_input *self, int fd, size_t hint) {
+  size_t capacity = hint + 1 > READ_CHUNK ? hint + 1 : READ_CHUNK;
+  size_t length = 0;
+  char *buffer = NULL, *newbuffer;
+  ssize_t got;
+
+  if (!(buffer = malloc(capacity))) goto fail;
+
+  for (;;) {
+    if (capacity - length < READ_CHUNK / 2) {
+      capacity *= 2;
+      if (!(newbuffer = realloc(buffer, capacity))) goto fail;
+      buffer = newbuffer;
+    }
+
+    got = read(fd, buffer + length, capacity - length - 1);
+    if (got < 0 && errno == EINTR) continue;
+    if (got < 0) goto fail;
+    if (got == 0) break;
+    length += (size_t)got;
+  }
+
+  buffer[length] = '\0';
+
+  self->data = buffer;
+  self->length = length;
+  self->mapped = 0;
+  return true;
+
+fail:
+  free(buffer);
+  return false;
+}
+
+bool aoc_input_load(aoc_input *self, char const *path) {
+  bool stdio = strcmp(path, "-") == 0;
+  struct stat st;
+  int fd = -1;
+
+  memset(self, 0, sizeof(*self));
+
+  if ((fd = stdio ? STDIN_FILENO : open(path, O_RDONLY)) < 0) {
+    fprintf(stderr, "could not open file '%s'\n", path);
+    perror("reason");
+    goto fail;
+  }
+
+  if (fstat(fd, &st) < 0) {
+    fprintf(stderr, "failed to get size of '%s'\n", path);
+    perror("reason");
+    goto fail;
+  }
+
+  // Empty files cannot be mapped, and anything that isn't a regular file
+  // (pipes, terminals, character devices) has to be read sequentially.
+  if (S_ISREG(st.st_mode) && st.st_size > 0) {
+    if (aoc_input_map(self, fd, (size_t)st.st_size)) goto done;
+  }
+
+  if (!aoc_input_read(self, fd, S_ISREG(st.st_mode) ? st.st_size : 0)) {
+    fprintf(stderr, "failed to read '%s'\n", path);
+    perror("reason");
+    goto fail;
+  }
+
+done:
+  if (!stdio) close(fd);
+  return true;
+
+fail:
+  if (fd >= 0 && !stdio) close(fd);
+  return false;
+}
+
+void aoc_input_free(aoc_input *self) {
+  if (self->mapped) {
+    munmap((void *)self->data, self->mapped);
+  } else {
+    free((void *)self->data);
+  }
+  memset(self, 0, sizeof(*self));
+}
+
+static bool aoc_input_read_answer(
+  char const *path,
+  size_t part,
+  uint64_t *answer
+) {
+  char line[64];
+  char *end;
+  FILE *file;
+  size_t i;
+  bool found = false;
+
+  if (!(file = fopen(path, "r"))) return false;
+
+  for (i = 1; fgets(line, sizeof(line), file); i++) {
+    if (i == part) {
+      *answer = strtoull(line, &end, 10);
+      found = end != line;
+      break;
+    }
+  }
+
+  fclose(file);
+  return found;
+}
+
+bool aoc_input_expected(char const *path, size_t part, uint64_t *answer) {
+  char const *slash, *dot;
+  char buffer[4096];
+  int dirlen, stemlen;
+
+  if (strcmp(path, "-") == 0) return false;
+
+  slash = strrchr(path, '/');
+  dot = strrchr(path, '.');
+  dirlen = slash ? (int)(slash - path + 1) : 0;
+  stemlen = (int)strlen(path);
+  if (dot && dot > path + dirlen) stemlen = (int)(dot - path);
+
+  snprintf(buffer, sizeof(buffer), "%.*s.expected.txt", stemlen, path);
+  if (aoc_input_read_answer(buffer, part, answer)) return true;
+
+  snprintf(buffer, sizeof(buffer), "%.*sexpected.txt", dirlen, path);
+  return aoc_input_read_answer(buffer, part, answer);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct aoc_input {
+  char const *data;
+  size_t length;
+  // Size of the read-only mapping backing `data`, or zero when the input was
+  // read into a heap buffer instead.
+  size_t mapped;
+} aoc_input;
+
+// Load the file at `path` as a NUL-terminated string. Regular files are mapped
+// directly into memory; pipes and other streams (including "-" for stdin) are
+// read into a heap buffer. Errors are reported on stderr.
+bool aoc_input_load(aoc_input *self, char const *path);
+
+void aoc_input_free(aoc_input *self);
+
+// Look up the expected answer for `part` of the input at `path`. Answers are
+// read from "[stem].expected.txt" next to the input, falling back to an
+// "expected.txt" in the same directory; line N holds the answer to part N.
+// Returns false if no expected answer is recorded.
+bool aoc_input_expected(char const *path, size_t part, uint64_t *answer);
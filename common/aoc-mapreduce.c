@@ -0,0 +1,108 @@
+#include "aoc-mapreduce.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "aoc-thread.h"
+#include "aoc-trace.h"
+
+// The result of one chunk, and whether `map` stopped before its end.
+typedef struct aoc_mapreduce_chunk {
+  uint64_t result;
+  bool stopped;
+} aoc_mapreduce_chunk;
+
+typedef struct aoc_mapreduce_job {
+  aoc_mapreduce const *mr;
+  char const *input;
+  size_t length;
+  aoc_mapreduce_chunk *chunks;
+} aoc_mapreduce_job;
+
+static char const *aoc_mapreduce_line(
+  void *ctx,
+  char const *at,
+  char const *end
+) {
+  char const *newline;
+
+  (void)ctx;
+  newline = memchr(at, '\n', end - at);
+  return newline ? newline + 1 : end;
+}
+
+static uint64_t aoc_mapreduce_sum(uint64_t lhs, uint64_t rhs) {
+  return lhs + rhs;
+}
+
+// Return the start of the first record at or after `offset`. The start of the
+// input is always a boundary.
+static char const *aoc_mapreduce_bound(
+  aoc_mapreduce_job const *job,
+  size_t offset
+) {
+  char const *end = job->input + job->length;
+  char const *at = job->input + offset;
+
+  if (offset == 0) return job->input;
+  if (offset >= job->length) return end;
+
+  // Splitting at line starts only needs to look for the next line if `at` is
+  // in the middle of one.
+  if (!job->mr->split) {
+    if (at[-1] == '\n') return at;
+    return aoc_mapreduce_line(NULL, at, end);
+  }
+
+  return job->mr->split(job->mr->ctx, at, end);
+}
+
+static void aoc_mapreduce_worker(void *ctx, size_t id, size_t count) {
+  aoc_mapreduce_job *job = ctx;
+  aoc_mapreduce const *mr = job->mr;
+  aoc_reduce_fn reduce = mr->reduce ? mr->reduce : aoc_mapreduce_sum;
+  char const *input = aoc_mapreduce_bound(job, job->length * id / count);
+  char const *end = aoc_mapreduce_bound(job, job->length * (id + 1) / count);
+  aoc_mapreduce_chunk *chunk = &job->chunks[id];
+  uint64_t value;
+
+  chunk->result = mr->identity;
+  chunk->stopped = false;
+
+  aoc_trace_begin("map");
+  while (input < end) {
+    if (!mr->map(mr->ctx, &input, &value)) {
+      chunk->stopped = true;
+      break;
+    }
+    chunk->result = reduce(chunk->result, value);
+  }
+  aoc_trace_end();
+}
+
+uint64_t aoc_mapreduce_run(
+  aoc_mapreduce const *self,
+  char const *input,
+  size_t length
+) {
+  aoc_mapreduce_job job = {self, input, length};
+  aoc_reduce_fn reduce = self->reduce ? self->reduce : aoc_mapreduce_sum;
+  size_t weight = self->weight ? self->weight : 1;
+  size_t i, count;
+  uint64_t result = self->identity;
+
+  count = length * weight < AOC_MAPREDUCE_PARALLEL ? 1 : aoc_thread_count();
+  if (!(job.chunks = malloc(count * sizeof(*job.chunks)))) abort();
+
+  // A run of records ends at the first one that `map` rejects, so the chunks
+  // after the first one that stopped early are dropped, just as they would
+  // never have been reached on one thread.
+  aoc_parallel(count, aoc_mapreduce_worker, &job);
+  for (i = 0; i < count; i++) {
+    result = reduce(result, job.chunks[i].result);
+    if (job.chunks[i].stopped) break;
+  }
+
+  free(job.chunks);
+  return result;
+}
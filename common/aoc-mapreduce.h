@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Parse the record at `*input`, advance past it and any separator after it,
+// and set `*value` to its result. The next record, if any, must start where
+// `*input` is left. Returns false if there is no record at `*input`.
+typedef bool (*aoc_map_fn)(void *ctx, char const **input, uint64_t *value);
+
+// Return the start of the first record at or after `at`, which is at most
+// `end`.
+typedef char const *(*aoc_split_fn)(void *ctx, char const *at, char const *end);
+
+// Combine the results of two runs of records, the earlier one first. Must be
+// associative.
+typedef uint64_t (*aoc_reduce_fn)(uint64_t lhs, uint64_t rhs);
+
+// How to process a run of independent records.
+typedef struct aoc_mapreduce {
+  aoc_map_fn map;
+  // Defaults to splitting at line starts.
+  aoc_split_fn split;
+  // Defaults to wrapping addition, with `identity` zero.
+  aoc_reduce_fn reduce;
+  uint64_t identity;
+  // Bytes of work that each byte of the range stands for, when `map` reads
+  // more than its record (such as a whole column of a grid from one row).
+  // Only used to decide whether to go parallel. Defaults to one.
+  size_t weight;
+  // Shared by every thread, so it must only be read by `map`.
+  void *ctx;
+} aoc_mapreduce;
+
+// Inputs with less work than this, in bytes, are processed on the calling
+// thread alone.
+#define AOC_MAPREDUCE_PARALLEL (64 * 1024)
+
+// Map every record in [input, input + length) and reduce the results in
+// input order, stopping at the first record that `map` rejects. Large inputs
+// are split at record boundaries into one chunk per thread; since each chunk
+// is reduced in order, the chunks are combined in order, and no chunk after
+// one that stopped early is combined, the result does not depend on the
+// thread count.
+uint64_t aoc_mapreduce_run(
+  aoc_mapreduce const *self,
+  char const *input,
+  size_t length
+);
@@ -0,0 +1,176 @@
+#include "aoc-parse.h"
+
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// The smallest page size of any platform we run on. A load of `n` bytes from
+// an address at most `PAGE_SIZE - n` bytes into a page stays inside that page,
+// and the page is mapped if the string reaches its start.
+#define PAGE_SIZE (4096)
+
+#define ONES (0x0101010101010101ull)
+
+static bool aoc_parse_can_load(char const *text, size_t n) {
+  return ((uintptr_t)text & (PAGE_SIZE - 1)) <= PAGE_SIZE - n;
+}
+
+static uint64_t aoc_parse_load8(char const *text) {
+  uint64_t word;
+  memcpy(&word, text, sizeof(word));
+  return word;
+}
+
+// Return a mask with the top bit set in every byte of `word` that is not an
+// ASCII digit. After subtracting '0' with the high bit cleared, digits are the
+// bytes below 10; adding 0x76 carries exactly those below 0x80.
+static uint64_t aoc_parse_nondigits8(uint64_t word) {
+  uint64_t value = word ^ (0x30 * ONES);
+  return (((value & (0x7f * ONES)) + 0x76 * ONES) | value) & (0x80 * ONES);
+}
+
+size_t aoc_parse_digits(char const *text) {
+  size_t count = 0;
+  uint64_t mask;
+
+#ifdef __SSE2__
+  while (aoc_parse_can_load(text + count, 16)) {
+    __m128i bytes = _mm_loadu_si128((__m128i const *)(text + count));
+    __m128i digits = _mm_sub_epi8(bytes, _mm_set1_epi8('0'));
+    // Digits are exactly the bytes that are at most 9 after subtracting '0',
+    // compared unsigned via min.
+    __m128i small = _mm_min_epu8(digits, _mm_set1_epi8(9));
+    unsigned bits = ~_mm_movemask_epi8(_mm_cmpeq_epi8(small, digits)) & 0xffff;
+
+    if (bits) return count + (size_t)__builtin_ctz(bits);
+    count += 16;
+  }
+#endif
+
+  while (aoc_parse_can_load(text + count, 8)) {
+    mask = aoc_parse_nondigits8(aoc_parse_load8(text + count));
+    if (mask) return count + (size_t)__builtin_ctzll(mask) / 8;
+    count += 8;
+  }
+
+  while ('0' <= text[count] && text[count] <= '9') {
+    count++;
+  }
+
+  return count;
+}
+
+// Convert the eight digits in `word`, first digit in the lowest byte, by
+// combining neighbouring digits, then pairs, then quads.
+static uint64_t aoc_parse_swar8(uint64_t word) {
+  word = (word * 10 + (word >> 8)) & 0x00ff00ff00ff00ffull;
+  word = (word * 100 + (word >> 16)) & 0x0000ffff0000ffffull;
+  return (word * 10000 + (word >> 32)) & 0xffffffffull;
+}
+
+static uint64_t aoc_parse_convert8(char const *text) {
+  return aoc_parse_swar8(aoc_parse_load8(text) - 0x30 * ONES);
+}
+
+uint64_t aoc_parse_convert(char const *text, size_t count) {
+  static uint64_t const powers[] = {
+    1,
+    10,
+    100,
+    1000,
+    10000,
+    100000,
+    1000000,
+    10000000,
+  };
+  uint64_t word, value = 0;
+
+  for (; count >= 16; text += 16, count -= 16) {
+    value = value * 100000000 + aoc_parse_convert8(text);
+    value = value * 100000000 + aoc_parse_convert8(text + 8);
+  }
+
+  if (count >= 8) {
+    value = value * 100000000 + aoc_parse_convert8(text);
+    text += 8;
+    count -= 8;
+  }
+
+  if (count == 0) return value;
+
+  // Shift the remaining digits to the top of the word so that the bytes below
+  // them read as leading zeros.
+  if (aoc_parse_can_load(text, 8)) {
+    word = (aoc_parse_load8(text) - 0x30 * ONES) << (8 * (8 - count));
+    return value * powers[count] + aoc_parse_swar8(word);
+  }
+
+  for (; count > 0; text++, count--) {
+    value = value * 10 + (uint64_t)(*text - '0');
+  }
+  return value;
+}
+
+bool aoc_parse_u64(char const **input, uint64_t *value) {
+  size_t count = aoc_parse_digits(*input);
+
+  if (count == 0) return false;
+
+  *value = aoc_parse_convert(*input, count);
+  *input += count;
+  return true;
+}
+
+bool aoc_parse_count(char const *text, size_t *value) {
+  size_t count = aoc_parse_digits(text), result = 0, i;
+  unsigned digit;
+
+  if (count == 0 || text[count] != '\0') return false;
+
+  for (i = 0; i < count; i++) {
+    digit = text[i] - '0';
+    if (result > (SIZE_MAX - digit) / 10) return false;
+    result = result * 10 + digit;
+  }
+
+  *value = result;
+  return true;
+}
+
+size_t aoc_parse_tuple(
+  char const **input,
+  char sep,
+  uint64_t *values,
+  size_t count
+) {
+  char const *text = *input, *next;
+  size_t i;
+
+  for (i = 0; i < count; i++) {
+    next = text;
+    if (i > 0 && !aoc_parse_char(&next, sep)) break;
+    if (!aoc_parse_u64(&next, &values[i])) break;
+    text = next;
+  }
+
+  *input = text;
+  return i;
+}
+
+bool aoc_parse_char(char const **input, char c) {
+  if (**input != c) return false;
+  (*input)++;
+  return true;
+}
+
+void aoc_parse_space(char const **input) {
+  char const *text = *input;
+
+  while (*text == ' ' || *text == '\t' || *text == '\n' || *text == '\r') {
+    text++;
+  }
+
+  *input = text;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Return the number of consecutive decimal digits at the start of `text`.
+// Digit runs are found 16 (SSE2) or 8 (SWAR) bytes at a time. Wide loads never
+// cross into a page that the string does not reach, so this is safe on any
+// NUL-terminated string, including mapped inputs.
+size_t aoc_parse_digits(char const *text);
+
+// Convert exactly `count` decimal digits at `text` to a number. The digits are
+// converted 16 or 8 at a time. Numbers with more than 19 digits wrap.
+uint64_t aoc_parse_convert(char const *text, size_t count);
+
+// Parse the unsigned decimal number at `*input` and advance past it. Returns
+// false, leaving `*input` alone, if it does not start with a digit.
+bool aoc_parse_u64(char const **input, uint64_t *value);
+
+// Parse `text` as a count, such as a command-line argument. It must be all
+// decimal digits, with no sign or spaces, and fit in a size_t.
+bool aoc_parse_count(char const *text, size_t *value);
+
+// Parse up to `count` unsigned numbers separated by `sep`, such as "1,2,3",
+// and advance past them. Returns the number of values parsed.
+size_t aoc_parse_tuple(
+  char const **input,
+  char sep,
+  uint64_t *values,
+  size_t count
+);
+
+// Advance past `c` if it is the next character. Returns whether it was.
+bool aoc_parse_char(char const **input, char c);
+
+// Advance past any spaces, tabs and line breaks.
+void aoc_parse_space(char const **input);
@@ -0,0 +1,209 @@
+#include "aoc-perf.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define CACHE_EVENT(cache, op, result)                                         \
+  ((PERF_COUNT_HW_CACHE_##cache) | (PERF_COUNT_HW_CACHE_OP_##op << 8) |        \
+   (PERF_COUNT_HW_CACHE_RESULT_##result << 16))
+
+typedef struct aoc_perf_event {
+  char const *name;
+  uint32_t type;
+  uint64_t config;
+} aoc_perf_event;
+
+static aoc_perf_event const aoc_perf_events[AOC_PERF_NCOUNTERS] = {
+  [AOC_PERF_CYCLES] = {
+    "cycles",
+    PERF_TYPE_HARDWARE,
+    PERF_COUNT_HW_CPU_CYCLES,
+  },
+  [AOC_PERF_INSTRUCTIONS] = {
+    "instructions",
+    PERF_TYPE_HARDWARE,
+    PERF_COUNT_HW_INSTRUCTIONS,
+  },
+  [AOC_PERF_BRANCHES] = {
+    "branches",
+    PERF_TYPE_HARDWARE,
+    PERF_COUNT_HW_BRANCH_INSTRUCTIONS,
+  },
+  [AOC_PERF_BRANCH_MISSES] = {
+    "branch-misses",
+    PERF_TYPE_HARDWARE,
+    PERF_COUNT_HW_BRANCH_MISSES,
+  },
+  [AOC_PERF_L1D_LOADS] = {
+    "L1d-loads",
+    PERF_TYPE_HW_CACHE,
+    CACHE_EVENT(L1D, READ, ACCESS),
+  },
+  [AOC_PERF_L1D_MISSES] = {
+    "L1d-misses",
+    PERF_TYPE_HW_CACHE,
+    CACHE_EVENT(L1D, READ, MISS),
+  },
+  [AOC_PERF_LLC_REFERENCES] = {
+    "LLC-references",
+    PERF_TYPE_HARDWARE,
+    PERF_COUNT_HW_CACHE_REFERENCES,
+  },
+  [AOC_PERF_LLC_MISSES] = {
+    "LLC-misses",
+    PERF_TYPE_HARDWARE,
+    PERF_COUNT_HW_CACHE_MISSES,
+  },
+};
+
+static int aoc_perf_event_open(aoc_perf_event const *event) {
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = event->type;
+  attr.config = event->config;
+  attr.disabled = 1;
+  attr.inherit = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format =
+    PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+bool aoc_perf_open(aoc_perf *self) {
+  size_t i, opened = 0;
+  int error = 0;
+
+  for (i = 0; i < AOC_PERF_NCOUNTERS; i++) {
+    self->fds[i] = aoc_perf_event_open(&aoc_perf_events[i]);
+    if (self->fds[i] >= 0) {
+      opened++;
+    } else if (!error) {
+      error = errno;
+    }
+  }
+
+  if (opened == 0) {
+    fprintf(stderr, "hardware counters unavailable: %s\n", strerror(error));
+    if (error == EACCES || error == EPERM) {
+      fprintf(stderr, "check /proc/sys/kernel/perf_event_paranoid\n");
+    }
+    return false;
+  }
+
+  return true;
+}
+
+void aoc_perf_close(aoc_perf *self) {
+  size_t i;
+
+  for (i = 0; i < AOC_PERF_NCOUNTERS; i++) {
+    if (self->fds[i] >= 0) close(self->fds[i]);
+    self->fds[i] = -1;
+  }
+}
+
+static void aoc_perf_ioctl(aoc_perf *self, unsigned long request) {
+  size_t i;
+
+  for (i = 0; i < AOC_PERF_NCOUNTERS; i++) {
+    if (self->fds[i] >= 0) ioctl(self->fds[i], request, 0);
+  }
+}
+
+void aoc_perf_reset(aoc_perf *self) {
+  aoc_perf_ioctl(self, PERF_EVENT_IOC_RESET);
+}
+
+void aoc_perf_enable(aoc_perf *self) {
+  aoc_perf_ioctl(self, PERF_EVENT_IOC_ENABLE);
+}
+
+void aoc_perf_disable(aoc_perf *self) {
+  aoc_perf_ioctl(self, PERF_EVENT_IOC_DISABLE);
+}
+
+void aoc_perf_read(aoc_perf const *self, aoc_perf_counts *counts) {
+  // value, time enabled, time running
+  uint64_t data[3];
+  size_t i;
+
+  memset(counts, 0, sizeof(*counts));
+
+  for (i = 0; i < AOC_PERF_NCOUNTERS; i++) {
+    if (self->fds[i] < 0) continue;
+    if (read(self->fds[i], data, sizeof(data)) != sizeof(data)) continue;
+
+    // A counter that never got scheduled onto the PMU has nothing to report.
+    if (data[2] == 0) continue;
+
+    counts->values[i] = data[0];
+    if (data[2] < data[1]) {
+      counts->values[i] = (uint64_t)((double)data[0] * data[1] / data[2]);
+    }
+    counts->valid[i] = true;
+  }
+}
+
+double aoc_perf_ratio(
+  aoc_perf_counts const *counts,
+  aoc_perf_counter num,
+  aoc_perf_counter den
+) {
+  if (!counts->valid[num] || !counts->valid[den]) return -1;
+  if (counts->values[den] == 0) return -1;
+  return (double)counts->values[num] / (double)counts->values[den];
+}
+
+static void aoc_perf_print_line(
+  FILE *file,
+  aoc_perf_counts const *counts,
+  aoc_perf_counter counter,
+  uint64_t runs
+) {
+  fprintf(file, "  %-16s", aoc_perf_events[counter].name);
+  if (counts->valid[counter]) {
+    fprintf(file, "%16" PRIu64, counts->values[counter] / runs);
+  } else {
+    fprintf(file, "%16s", "n/a");
+  }
+}
+
+static void aoc_perf_print_rate(FILE *file, double rate, char const *format) {
+  if (rate >= 0) fprintf(file, format, rate);
+  fprintf(file, "\n");
+}
+
+void aoc_perf_print(FILE *file, aoc_perf_counts const *counts, uint64_t runs) {
+  double rate;
+
+  if (runs == 0) runs = 1;
+
+  aoc_perf_print_line(file, counts, AOC_PERF_CYCLES, runs);
+  fprintf(file, "\n");
+
+  aoc_perf_print_line(file, counts, AOC_PERF_INSTRUCTIONS, runs);
+  rate = aoc_perf_ratio(counts, AOC_PERF_INSTRUCTIONS, AOC_PERF_CYCLES);
+  aoc_perf_print_rate(file, rate, "  # %.2f IPC");
+
+  aoc_perf_print_line(file, counts, AOC_PERF_BRANCH_MISSES, runs);
+  rate = aoc_perf_ratio(counts, AOC_PERF_BRANCH_MISSES, AOC_PERF_BRANCHES);
+  aoc_perf_print_rate(file, rate * 100, "  # %.2f%% of branches");
+
+  aoc_perf_print_line(file, counts, AOC_PERF_L1D_MISSES, runs);
+  rate = aoc_perf_ratio(counts, AOC_PERF_L1D_MISSES, AOC_PERF_L1D_LOADS);
+  aoc_perf_print_rate(file, rate * 100, "  # %.2f%% of L1d loads");
+
+  aoc_perf_print_line(file, counts, AOC_PERF_LLC_MISSES, runs);
+  rate = aoc_perf_ratio(counts, AOC_PERF_LLC_MISSES, AOC_PERF_LLC_REFERENCES);
+  aoc_perf_print_rate(file, rate * 100, "  # %.2f%% of LLC references");
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef enum aoc_perf_counter {
+  AOC_PERF_CYCLES,
+  AOC_PERF_INSTRUCTIONS,
+  AOC_PERF_BRANCHES,
+  AOC_PERF_BRANCH_MISSES,
+  AOC_PERF_L1D_LOADS,
+  AOC_PERF_L1D_MISSES,
+  AOC_PERF_LLC_REFERENCES,
+  AOC_PERF_LLC_MISSES,
+  AOC_PERF_NCOUNTERS,
+} aoc_perf_counter;
+
+typedef struct aoc_perf {
+  int fds[AOC_PERF_NCOUNTERS];
+} aoc_perf;
+
+typedef struct aoc_perf_counts {
+  uint64_t values[AOC_PERF_NCOUNTERS];
+  bool valid[AOC_PERF_NCOUNTERS];
+} aoc_perf_counts;
+
+// Open hardware counters for the calling thread and any threads it creates
+// afterwards. Counters the kernel or hardware refuses are left closed and
+// reported as unavailable; returns false (after explaining why on stderr) only
+// if none of them could be opened.
+bool aoc_perf_open(aoc_perf *self);
+
+void aoc_perf_close(aoc_perf *self);
+
+// Zero every open counter.
+void aoc_perf_reset(aoc_perf *self);
+
+// Start or stop counting. Counts accumulate across enable/disable pairs until
+// the next reset.
+void aoc_perf_enable(aoc_perf *self);
+void aoc_perf_disable(aoc_perf *self);
+
+// Read the current counts, scaled up if the kernel had to multiplex counters.
+void aoc_perf_read(aoc_perf const *self, aoc_perf_counts *counts);
+
+// Return `num / den` of two counters, or a negative value if either counter is
+// unavailable or the denominator is zero.
+double aoc_perf_ratio(
+  aoc_perf_counts const *counts,
+  aoc_perf_counter num,
+  aoc_perf_counter den
+);
+
+// Print the counts along with IPC and miss rates, with every count divided by
+// `runs`.
+void aoc_perf_print(FILE *file, aoc_perf_counts const *counts, uint64_t runs);
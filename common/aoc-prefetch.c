@@ -0,0 +1,102 @@
+#include "aoc-prefetch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "aoc-trace.h"
+
+#include <unistd.h>
+
+// Read one byte of every page so that a mapped input is faulted in by the
+// background thread rather than by whoever processes it.
+static void aoc_prefetch_touch(aoc_input const *input) {
+  size_t pagesize = (size_t)sysconf(_SC_PAGESIZE);
+  volatile char const *data = input->data;
+  size_t i;
+
+  for (i = 0; i < input->length; i += pagesize) {
+    (void)data[i];
+  }
+}
+
+static void *aoc_prefetch_main(void *arg) {
+  aoc_prefetch *self = arg;
+  aoc_prefetch_slot *slot;
+  aoc_input input;
+  bool loaded;
+  size_t i;
+
+  for (i = 0; i < self->npaths; i++) {
+    slot = &self->slots[i % AOC_PREFETCH_DEPTH];
+
+    // Wait for the consumer to take the input that used this slot last.
+    pthread_mutex_lock(&self->lock);
+    while (slot->ready) {
+      pthread_cond_wait(&self->cond, &self->lock);
+    }
+    pthread_mutex_unlock(&self->lock);
+
+    aoc_trace_begin("load");
+    if ((loaded = aoc_input_load(&input, self->paths[i]))) {
+      if (input.mapped) aoc_prefetch_touch(&input);
+    }
+    aoc_trace_end();
+
+    pthread_mutex_lock(&self->lock);
+    slot->input = input;
+    slot->loaded = loaded;
+    slot->ready = true;
+    pthread_cond_broadcast(&self->cond);
+    pthread_mutex_unlock(&self->lock);
+  }
+
+  return NULL;
+}
+
+void aoc_prefetch_start(
+  aoc_prefetch *self,
+  char const *const *paths,
+  size_t npaths
+) {
+  memset(self, 0, sizeof(*self));
+  self->paths = paths;
+  self->npaths = npaths;
+
+  if (pthread_mutex_init(&self->lock, NULL)) abort();
+  if (pthread_cond_init(&self->cond, NULL)) abort();
+  if (pthread_create(&self->thread, NULL, aoc_prefetch_main, self)) abort();
+}
+
+bool aoc_prefetch_next(aoc_prefetch *self, aoc_input *input, bool *loaded) {
+  aoc_prefetch_slot *slot;
+
+  if (self->taken == self->npaths) return false;
+  slot = &self->slots[self->taken % AOC_PREFETCH_DEPTH];
+
+  pthread_mutex_lock(&self->lock);
+  while (!slot->ready) {
+    pthread_cond_wait(&self->cond, &self->lock);
+  }
+  *input = slot->input;
+  *loaded = slot->loaded;
+  slot->ready = false;
+  pthread_cond_broadcast(&self->cond);
+  pthread_mutex_unlock(&self->lock);
+
+  self->taken++;
+  return true;
+}
+
+void aoc_prefetch_stop(aoc_prefetch *self) {
+  aoc_input input;
+  bool loaded;
+
+  // The loader never stops early, so drain whatever it still has to load.
+  while (aoc_prefetch_next(self, &input, &loaded)) {
+    if (loaded) aoc_input_free(&input);
+  }
+
+  pthread_join(self->thread, NULL);
+  pthread_cond_destroy(&self->cond);
+  pthread_mutex_destroy(&self->lock);
+}
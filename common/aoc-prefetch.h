@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "aoc-input.h"
+
+#include <pthread.h>
+
+// Number of inputs that may be loaded ahead of the one being processed.
+#define AOC_PREFETCH_DEPTH (2)
+
+typedef struct aoc_prefetch_slot {
+  aoc_input input;
+  bool ready;
+  bool loaded;
+} aoc_prefetch_slot;
+
+// Loads a list of inputs in order on a background thread, staying up to
+// AOC_PREFETCH_DEPTH inputs ahead of the consumer, so that reading the next
+// file overlaps with solving the current one.
+typedef struct aoc_prefetch {
+  char const *const *paths;
+  size_t npaths;
+  // Number of inputs handed to the consumer so far.
+  size_t taken;
+  aoc_prefetch_slot slots[AOC_PREFETCH_DEPTH];
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+} aoc_prefetch;
+
+// Start loading `paths`, which must stay valid until `aoc_prefetch_stop`.
+void aoc_prefetch_start(
+  aoc_prefetch *self,
+  char const *const *paths,
+  size_t npaths
+);
+
+// Wait for the next input in the list and move it into `input`, which the
+// caller then frees with `aoc_input_free`. Sets `loaded` to false if the file
+// could not be loaded (the error has been reported on stderr). Returns false
+// once every input has been handed out.
+bool aoc_prefetch_next(aoc_prefetch *self, aoc_input *input, bool *loaded);
+
+// Wait for the background thread and free any inputs that were not taken.
+void aoc_prefetch_stop(aoc_prefetch *self);
@@ -0,0 +1,31 @@
+#include "aoc-registry.h"
+
+#include <string.h>
+
+// The list of days is generated by the Makefile from the sources in the tree.
+// When building the runner, each day is compiled with its `part1` and `part2`
+// renamed to `[sym]_part1` and `[sym]_part2` so that they can be linked into a
+// single binary.
+#define AOC_DAY(sym, name)                                                     \
+  uint64_t sym##_part1(char const *input);                                     \
+  uint64_t sym##_part2(char const *input);
+#include "aoc-days.h"
+#undef AOC_DAY
+
+aoc_day const aoc_days[] = {
+#define AOC_DAY(sym, name) {name, {sym##_part1, sym##_part2}},
+#include "aoc-days.h"
+#undef AOC_DAY
+};
+
+size_t const aoc_ndays = sizeof(aoc_days) / sizeof(aoc_days[0]);
+
+aoc_day const *aoc_day_find(char const *name) {
+  size_t i;
+
+  for (i = 0; i < aoc_ndays; i++) {
+    if (strcmp(aoc_days[i].name, name) == 0) return &aoc_days[i];
+  }
+
+  return NULL;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint64_t (*aoc_part)(char const *input);
+
+typedef struct aoc_day {
+  // Name of the day in the same "[year]/[day]" form used by the source tree,
+  // e.g. "2025/05".
+  char const *name;
+  aoc_part parts[2];
+} aoc_day;
+
+// Every day in the tree, sorted by name.
+extern aoc_day const aoc_days[];
+extern size_t const aoc_ndays;
+
+// Return the day registered under `name`, or NULL if there is none.
+aoc_day const *aoc_day_find(char const *name);
@@ -0,0 +1,57 @@
+#include "aoc-rng.h"
+
+#include <stddef.h>
+
+static uint64_t aoc_rng_rotl(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+void aoc_rng_seed(aoc_rng *self, uint64_t seed) {
+  size_t i;
+  uint64_t z;
+
+  // Expand the seed with splitmix64 so that similar seeds still produce
+  // unrelated states, and the state is never all zero.
+  for (i = 0; i < 4; i++) {
+    z = (seed += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    self->state[i] = z ^ (z >> 31);
+  }
+}
+
+uint64_t aoc_rng_next(aoc_rng *self) {
+  uint64_t *s = self->state;
+  uint64_t result = aoc_rng_rotl(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = aoc_rng_rotl(s[3], 45);
+
+  return result;
+}
+
+uint64_t aoc_rng_below(aoc_rng *self, uint64_t bound) {
+  uint64_t value, threshold = -bound % bound;
+
+  // Reject the few values at the bottom of the range that would make some
+  // results more likely than others.
+  do {
+    value = aoc_rng_next(self);
+  } while (value < threshold);
+
+  return value % bound;
+}
+
+uint64_t aoc_rng_range(aoc_rng *self, uint64_t min, uint64_t max) {
+  if (max - min == UINT64_MAX) return aoc_rng_next(self);
+  return min + aoc_rng_below(self, max - min + 1);
+}
+
+bool aoc_rng_chance(aoc_rng *self, uint64_t numerator, uint64_t denominator) {
+  return aoc_rng_below(self, denominator) < numerator;
+}
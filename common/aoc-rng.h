@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// A small, fast pseudo-random generator (xoshiro256**). The same seed always
+// produces the same sequence, so generated inputs are reproducible.
+typedef struct aoc_rng {
+  uint64_t state[4];
+} aoc_rng;
+
+void aoc_rng_seed(aoc_rng *self, uint64_t seed);
+
+uint64_t aoc_rng_next(aoc_rng *self);
+
+// Return a uniformly distributed value in [0, bound). `bound` must not be 0.
+uint64_t aoc_rng_below(aoc_rng *self, uint64_t bound);
+
+// Return a uniformly distributed value in [min, max].
+uint64_t aoc_rng_range(aoc_rng *self, uint64_t min, uint64_t max);
+
+// Return true with probability `numerator / denominator`.
+bool aoc_rng_chance(aoc_rng *self, uint64_t numerator, uint64_t denominator);
@@ -0,0 +1,256 @@
+#include "aoc-sort.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "aoc-thread.h"
+
+#define AOC_SORT_RADIX (256)
+
+// Arrays shorter than this are insertion sorted.
+#define AOC_SORT_SMALL (64)
+
+// Arrays shorter than this are sorted on the calling thread alone.
+#define AOC_SORT_PARALLEL (64 * 1024)
+
+typedef struct aoc_sort_entry {
+  uint64_t key;
+  size_t index;
+} aoc_sort_entry;
+
+// State shared by the threads of one sort. Each phase of the sort is a
+// separate call to aoc_parallel, and every thread works on its own slice.
+typedef struct aoc_sort_job {
+  char *items;
+  size_t size;
+  aoc_sort_key_fn key;
+  uint64_t flip;
+
+  aoc_sort_entry *src;
+  aoc_sort_entry *dst;
+  size_t count;
+
+  size_t nthreads;
+  size_t (*counts)[AOC_SORT_RADIX];
+  uint64_t *diffs;
+  unsigned shift;
+
+  char *out;
+} aoc_sort_job;
+
+static size_t aoc_sort_bound(size_t count, size_t id, size_t nthreads) {
+  return count * id / nthreads;
+}
+
+static unsigned aoc_sort_digit(aoc_sort_job const *job, uint64_t key) {
+  return (key >> job->shift) & (AOC_SORT_RADIX - 1);
+}
+
+// Extract every key, and record which key bits differ from the first key so
+// that passes over uniform bytes can be skipped.
+static void aoc_sort_keys(void *ctx, size_t id, size_t nthreads) {
+  aoc_sort_job *job = ctx;
+  size_t i = aoc_sort_bound(job->count, id, nthreads);
+  size_t end = aoc_sort_bound(job->count, id + 1, nthreads);
+  uint64_t first = job->key(job->items) ^ job->flip;
+  uint64_t key, diff = 0;
+
+  for (; i < end; i++) {
+    key = job->key(job->items + i * job->size) ^ job->flip;
+    job->src[i] = (aoc_sort_entry){key, i};
+    diff |= key ^ first;
+  }
+
+  job->diffs[id] = diff;
+}
+
+static void aoc_sort_count(void *ctx, size_t id, size_t nthreads) {
+  aoc_sort_job *job = ctx;
+  size_t i = aoc_sort_bound(job->count, id, nthreads);
+  size_t end = aoc_sort_bound(job->count, id + 1, nthreads);
+  size_t *counts = job->counts[id];
+
+  memset(counts, 0, sizeof(job->counts[id]));
+  for (; i < end; i++) {
+    counts[aoc_sort_digit(job, job->src[i].key)]++;
+  }
+}
+
+static void aoc_sort_scatter(void *ctx, size_t id, size_t nthreads) {
+  aoc_sort_job *job = ctx;
+  size_t i = aoc_sort_bound(job->count, id, nthreads);
+  size_t end = aoc_sort_bound(job->count, id + 1, nthreads);
+  size_t *offsets = job->counts[id];
+
+  for (; i < end; i++) {
+    job->dst[offsets[aoc_sort_digit(job, job->src[i].key)]++] = job->src[i];
+  }
+}
+
+static void aoc_sort_gather(void *ctx, size_t id, size_t nthreads) {
+  aoc_sort_job *job = ctx;
+  size_t i = aoc_sort_bound(job->count, id, nthreads);
+  size_t end = aoc_sort_bound(job->count, id + 1, nthreads);
+
+  for (; i < end; i++) {
+    memcpy(
+      job->out + i * job->size,
+      job->items + job->src[i].index * job->size,
+      job->size
+    );
+  }
+}
+
+// Turn the per-thread digit counts into the offset each thread scatters each
+// digit to. Digits are laid out in order and, within a digit, threads are laid
+// out in order, which keeps every pass stable.
+static void aoc_sort_offsets(aoc_sort_job *job) {
+  size_t digit, id, count, sum = 0;
+
+  for (digit = 0; digit < AOC_SORT_RADIX; digit++) {
+    for (id = 0; id < job->nthreads; id++) {
+      count = job->counts[id][digit];
+      job->counts[id][digit] = sum;
+      sum += count;
+    }
+  }
+}
+
+static void aoc_sort_insertion(aoc_sort_entry *entries, size_t count) {
+  aoc_sort_entry entry;
+  size_t i, j;
+
+  for (i = 1; i < count; i++) {
+    entry = entries[i];
+    for (j = i; j > 0 && entries[j - 1].key > entry.key; j--) {
+      entries[j] = entries[j - 1];
+    }
+    entries[j] = entry;
+  }
+}
+
+// LSD radix sort the first `job->count` entries of `job->src`, one byte per
+// pass, skipping bytes where no key differs.
+static void aoc_sort_radix(aoc_sort_job *job, uint64_t diff) {
+  aoc_sort_entry *temp;
+  unsigned byte;
+
+  if (job->count < AOC_SORT_SMALL) {
+    aoc_sort_insertion(job->src, job->count);
+    return;
+  }
+
+  for (byte = 0; byte < 8; byte++) {
+    job->shift = byte * 8;
+    if (aoc_sort_digit(job, diff) == 0) continue;
+
+    aoc_parallel(job->nthreads, aoc_sort_count, job);
+    aoc_sort_offsets(job);
+    aoc_parallel(job->nthreads, aoc_sort_scatter, job);
+
+    temp = job->src;
+    job->src = job->dst;
+    job->dst = temp;
+  }
+}
+
+// Move the entries whose highest differing byte is small enough to hold the
+// first `limit` keys to the front of `job->src`, keeping their order, and
+// return how many there are. The rest follow them.
+static size_t aoc_sort_select(aoc_sort_job *job, uint64_t diff, size_t limit) {
+  size_t digit, cutoff, id, i, nfront, nback, seen = 0;
+  aoc_sort_entry *temp;
+
+  job->shift = 56;
+  while (aoc_sort_digit(job, diff) == 0) job->shift -= 8;
+
+  aoc_parallel(job->nthreads, aoc_sort_count, job);
+  for (cutoff = 0; cutoff < AOC_SORT_RADIX; cutoff++) {
+    for (id = 0; id < job->nthreads; id++) {
+      seen += job->counts[id][cutoff];
+    }
+    if (seen >= limit) break;
+  }
+
+  for (i = nfront = 0, nback = seen; i < job->count; i++) {
+    digit = aoc_sort_digit(job, job->src[i].key);
+    if (digit <= cutoff) {
+      job->dst[nfront++] = job->src[i];
+    } else {
+      job->dst[nback++] = job->src[i];
+    }
+  }
+
+  temp = job->src;
+  job->src = job->dst;
+  job->dst = temp;
+  return seen;
+}
+
+void aoc_sort_top(
+  void *items,
+  size_t count,
+  size_t size,
+  aoc_sort_key_fn key,
+  aoc_sort_order order,
+  size_t limit
+) {
+  aoc_sort_job job = {.items = items, .size = size, .key = key};
+  aoc_sort_entry *rest;
+  uint64_t diff = 0;
+  size_t id, nfront = count;
+
+  if (count < 2 || limit == 0) return;
+  if (limit > count) limit = count;
+
+  // Descending order is an ascending sort on the complemented keys.
+  if (order == AOC_SORT_DESCENDING) job.flip = ~(uint64_t)0;
+
+  job.count = count;
+  job.nthreads = count < AOC_SORT_PARALLEL ? 1 : aoc_thread_count();
+  job.src = malloc(count * sizeof(*job.src));
+  job.dst = malloc(count * sizeof(*job.dst));
+  job.counts = malloc(job.nthreads * sizeof(*job.counts));
+  job.diffs = malloc(job.nthreads * sizeof(*job.diffs));
+  job.out = malloc(count * size);
+  if (!job.src || !job.dst || !job.counts || !job.diffs || !job.out) abort();
+
+  aoc_parallel(job.nthreads, aoc_sort_keys, &job);
+  for (id = 0; id < job.nthreads; id++) {
+    diff |= job.diffs[id];
+  }
+
+  if (diff != 0) {
+    if (limit < count / 2 && count >= AOC_SORT_SMALL) {
+      nfront = job.count = aoc_sort_select(&job, diff, limit);
+    }
+
+    // Only the front is sorted, so the rest has to be carried over if the
+    // sorted entries end up in the other buffer.
+    rest = job.src;
+    aoc_sort_radix(&job, diff);
+    if (job.src != rest) {
+      memcpy(job.src + nfront, rest + nfront, (count - nfront) * sizeof(*rest));
+    }
+
+    job.count = count;
+    aoc_parallel(job.nthreads, aoc_sort_gather, &job);
+    memcpy(items, job.out, count * size);
+  }
+
+  free(job.out);
+  free(job.diffs);
+  free(job.counts);
+  free(job.dst);
+  free(job.src);
+}
+
+void aoc_sort(
+  void *items,
+  size_t count,
+  size_t size,
+  aoc_sort_key_fn key,
+  aoc_sort_order order
+) {
+  aoc_sort_top(items, count, size, key, order, count);
+}
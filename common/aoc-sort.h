@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Return the key to sort the record at `item` by.
+typedef uint64_t (*aoc_sort_key_fn)(void const *item);
+
+typedef enum aoc_sort_order {
+  AOC_SORT_ASCENDING,
+  AOC_SORT_DESCENDING,
+} aoc_sort_order;
+
+// Sort `count` records of `size` bytes at `items` by the key that `key`
+// extracts from each. Each key is extracted exactly once, and large arrays are
+// radix sorted across aoc_thread_count() threads. The sort is stable.
+void aoc_sort(
+  void *items,
+  size_t count,
+  size_t size,
+  aoc_sort_key_fn key,
+  aoc_sort_order order
+);
+
+// Like aoc_sort, but only the first `limit` records are guaranteed to be in
+// order. The remaining records follow in an unspecified order. This is much
+// cheaper than a full sort when `limit` is small.
+void aoc_sort_top(
+  void *items,
+  size_t count,
+  size_t size,
+  aoc_sort_key_fn key,
+  aoc_sort_order order,
+  size_t limit
+);
@@ -0,0 +1,109 @@
+#include "aoc-stream.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+bool aoc_stream_open(aoc_stream *self, char const *path, size_t chunk) {
+  bool stdio = strcmp(path, "-") == 0;
+
+  memset(self, 0, sizeof(*self));
+
+  if ((self->fd = stdio ? STDIN_FILENO : open(path, O_RDONLY)) < 0) {
+    fprintf(stderr, "could not open file '%s'\n", path);
+    perror("reason");
+    return false;
+  }
+
+  // One byte past the chunk is kept free so that a final record without a
+  // trailing delimiter can still be NUL-terminated.
+  self->chunk = chunk ? chunk : AOC_STREAM_CHUNK;
+  self->capacity = self->chunk;
+  if (!(self->buffer = malloc(self->capacity + 1))) abort();
+
+  return true;
+}
+
+// Make room for another chunk at the end of the buffer, moving the unconsumed
+// data to the front first. Only grows the buffer if a single record already
+// fills it.
+static void aoc_stream_compact(aoc_stream *self) {
+  char *buffer;
+
+  if (self->begin > 0) {
+    memmove(self->buffer, self->buffer + self->begin, self->end - self->begin);
+    self->end -= self->begin;
+    self->scan -= self->begin;
+    self->begin = 0;
+  }
+
+  if (self->end == self->capacity) {
+    self->capacity *= 2;
+    if (!(buffer = realloc(self->buffer, self->capacity + 1))) abort();
+    self->buffer = buffer;
+  }
+}
+
+static bool aoc_stream_fill(aoc_stream *self) {
+  size_t want;
+  ssize_t got;
+
+  aoc_stream_compact(self);
+
+  want = self->capacity - self->end;
+  if (want > self->chunk) want = self->chunk;
+
+  do {
+    got = read(self->fd, self->buffer + self->end, want);
+  } while (got < 0 && errno == EINTR);
+
+  if (got < 0) {
+    perror("failed to read input");
+    self->failed = true;
+    return false;
+  }
+
+  self->eof = got == 0;
+  self->end += (size_t)got;
+  self->bytes += (uint64_t)got;
+  return true;
+}
+
+char *aoc_stream_next(aoc_stream *self, char delim, size_t *length) {
+  char *record, *found;
+
+  for (;;) {
+    record = self->buffer + self->begin;
+    found = memchr(self->buffer + self->scan, delim, self->end - self->scan);
+
+    if (found) {
+      *found = '\0';
+      *length = (size_t)(found - record);
+      self->begin = self->scan = (size_t)(found - self->buffer) + 1;
+      return record;
+    }
+
+    self->scan = self->end;
+
+    if (self->eof) {
+      if (self->begin == self->end) return NULL;
+      self->buffer[self->end] = '\0';
+      *length = self->end - self->begin;
+      self->begin = self->scan = self->end;
+      return record;
+    }
+
+    if (!aoc_stream_fill(self)) return NULL;
+  }
+}
+
+void aoc_stream_close(aoc_stream *self) {
+  if (self->fd >= 0 && self->fd != STDIN_FILENO) close(self->fd);
+  free(self->buffer);
+  memset(self, 0, sizeof(*self));
+  self->fd = -1;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Default number of bytes read from the input at a time.
+#define AOC_STREAM_CHUNK (64 * 1024)
+
+// An input read a fixed-size chunk at a time and handed out one record at a
+// time, so that memory use depends on the longest record rather than the size
+// of the input.
+typedef struct aoc_stream {
+  char *buffer;
+  size_t capacity;
+  size_t chunk;
+  // Unconsumed data is buffer[begin, end); buffer[begin, scan) is known not to
+  // contain the delimiter.
+  size_t begin;
+  size_t scan;
+  size_t end;
+  // Total number of bytes read from the input so far.
+  uint64_t bytes;
+  int fd;
+  bool eof;
+  bool failed;
+} aoc_stream;
+
+// Open the file at `path` ("-" for stdin) for streaming in reads of `chunk`
+// bytes. Errors are reported on stderr.
+bool aoc_stream_open(aoc_stream *self, char const *path, size_t chunk);
+
+// Return the next record, up to but not including `delim`, as a NUL-terminated
+// string in the stream's buffer. The record stays valid until the next call. A
+// record split across chunks is reassembled; one longer than a chunk grows the
+// buffer. Returns NULL at the end of the input or on a read error, which sets
+// `failed` and is reported on stderr.
+char *aoc_stream_next(aoc_stream *self, char delim, size_t *length);
+
+void aoc_stream_close(aoc_stream *self);
@@ -0,0 +1,96 @@
+#include "aoc-thread.h"
+
+#include <stdlib.h>
+
+#include "aoc-alloc.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+typedef struct aoc_thread_task {
+  aoc_thread_fn fn;
+  void *ctx;
+  size_t id;
+  size_t count;
+  size_t budget;
+  aoc_alloc_stats *alloc;
+} aoc_thread_task;
+
+// The share of the threads given to the current call of an aoc_parallel
+// worker, or zero outside of one.
+static _Thread_local size_t aoc_thread_budget;
+
+size_t aoc_thread_count(void) {
+  char const *env = getenv("AOC_THREADS");
+  long count;
+
+  if (aoc_thread_budget) return aoc_thread_budget;
+  if (env && (count = strtol(env, NULL, 10)) > 0) return (size_t)count;
+  if ((count = sysconf(_SC_NPROCESSORS_ONLN)) > 0) return (size_t)count;
+  return 1;
+}
+
+static void *aoc_thread_main(void *arg) {
+  aoc_thread_task *task = arg;
+  size_t budget = aoc_thread_budget;
+
+  aoc_alloc_track(task->alloc);
+  aoc_thread_budget = task->budget;
+  task->fn(task->ctx, task->id, task->count);
+  aoc_thread_budget = budget;
+  return NULL;
+}
+
+void aoc_parallel(size_t count, aoc_thread_fn fn, void *ctx) {
+  pthread_t *threads;
+  aoc_thread_task *tasks;
+  aoc_alloc_stats *alloc;
+  size_t i, budget;
+
+  if (count <= 1) {
+    fn(ctx, 0, 1);
+    return;
+  }
+
+  // Workers inherit the caller's allocation tracking so that memory a part
+  // allocates on its worker threads is attributed to the part.
+  alloc = aoc_alloc_current();
+
+  // Split the caller's threads between the workers, so that parallel work
+  // nested inside them does not start more threads than there are to spare.
+  budget = aoc_thread_count() / count;
+  if (budget == 0) budget = 1;
+
+  threads = malloc(count * sizeof(*threads));
+  tasks = malloc(count * sizeof(*tasks));
+  if (!threads || !tasks) abort();
+
+  for (i = 0; i < count; i++) {
+    tasks[i] = (aoc_thread_task){fn, ctx, i, count, budget, alloc};
+  }
+
+  for (i = 1; i < count; i++) {
+    if (pthread_create(&threads[i], NULL, aoc_thread_main, &tasks[i])) abort();
+  }
+
+  aoc_thread_main(&tasks[0]);
+
+  for (i = 1; i < count; i++) {
+    pthread_join(threads[i], NULL);
+  }
+
+  free(tasks);
+  free(threads);
+}
+
+void aoc_barrier_init(aoc_barrier *self, size_t count) {
+  if (pthread_barrier_init(&self->barrier, NULL, (unsigned)count)) abort();
+}
+
+void aoc_barrier_wait(aoc_barrier *self) {
+  pthread_barrier_wait(&self->barrier);
+}
+
+void aoc_barrier_destroy(aoc_barrier *self) {
+  pthread_barrier_destroy(&self->barrier);
+}
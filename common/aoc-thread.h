@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <pthread.h>
+
+typedef void (*aoc_thread_fn)(void *ctx, size_t id, size_t count);
+
+// Return the number of worker threads to use for parallel work. This is the
+// value of the AOC_THREADS environment variable if set, or the number of
+// online processors otherwise. Inside a worker of aoc_parallel, it is instead
+// that worker's share of the threads of the caller, and at least one.
+size_t aoc_thread_count(void);
+
+// Call `fn` on `count` threads at once and wait for all of them to finish.
+// Each call receives its own `id` in [0, count); the calling thread runs the
+// call with id 0.
+void aoc_parallel(size_t count, aoc_thread_fn fn, void *ctx);
+
+// A barrier for the `count` threads of one aoc_parallel call, for work that
+// runs in phases that must all finish before the next one starts.
+typedef struct aoc_barrier {
+  pthread_barrier_t barrier;
+} aoc_barrier;
+
+void aoc_barrier_init(aoc_barrier *self, size_t count);
+
+// Wait until all `count` threads have reached the barrier.
+void aoc_barrier_wait(aoc_barrier *self);
+
+void aoc_barrier_destroy(aoc_barrier *self);
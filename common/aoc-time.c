@@ -0,0 +1,13 @@
+#include "aoc-time.h"
+
+#include <time.h>
+
+uint64_t aoc_time_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+double aoc_time_ms(uint64_t ns) {
+  return (double)ns / 1e6;
+}
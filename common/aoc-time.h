@@ -0,0 +1,9 @@
+#pragma once
+
+#include <stdint.h>
+
+// Return the current value of the monotonic clock in nanoseconds.
+uint64_t aoc_time_ns(void);
+
+// Convert a duration in nanoseconds to (fractional) milliseconds.
+double aoc_time_ms(uint64_t ns);
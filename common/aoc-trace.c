@@ -0,0 +1,132 @@
+#include "aoc-trace.h"
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aoc-time.h"
+
+#include <pthread.h>
+
+typedef struct aoc_trace_event {
+  char const *name;
+  uint64_t ts;
+  char phase;
+} aoc_trace_event;
+
+// Each thread records into its own buffer so that recording never contends on
+// a lock. The buffers are chained together when they are first used so that
+// they can all be written out at the end.
+typedef struct aoc_trace_buffer {
+  aoc_trace_event *items;
+  size_t count;
+  size_t capacity;
+  size_t tid;
+  struct aoc_trace_buffer *next;
+} aoc_trace_buffer;
+
+bool aoc_trace_enabled = false;
+
+static char const *aoc_trace_path;
+static uint64_t aoc_trace_epoch;
+static pthread_mutex_t aoc_trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static aoc_trace_buffer *aoc_trace_buffers;
+static size_t aoc_trace_threads;
+static _Thread_local aoc_trace_buffer *aoc_trace_local;
+
+void aoc_trace_init(char const *path) {
+  if (!path) path = getenv("AOC_TRACE");
+  if (!path || !*path) return;
+
+  aoc_trace_path = path;
+  aoc_trace_epoch = aoc_time_ns();
+  aoc_trace_enabled = true;
+}
+
+static aoc_trace_buffer *aoc_trace_buffer_get(void) {
+  aoc_trace_buffer *buffer = aoc_trace_local;
+
+  if (!buffer) {
+    if (!(buffer = calloc(1, sizeof(*buffer)))) abort();
+
+    pthread_mutex_lock(&aoc_trace_lock);
+    buffer->tid = ++aoc_trace_threads;
+    buffer->next = aoc_trace_buffers;
+    aoc_trace_buffers = buffer;
+    pthread_mutex_unlock(&aoc_trace_lock);
+
+    aoc_trace_local = buffer;
+  }
+
+  return buffer;
+}
+
+void aoc_trace_record(char const *name, char phase) {
+  aoc_trace_buffer *buffer = aoc_trace_buffer_get();
+  aoc_trace_event *items;
+  size_t capacity;
+
+  if (buffer->count == buffer->capacity) {
+    capacity = buffer->capacity ? buffer->capacity * 2 : 256;
+    items = realloc(buffer->items, capacity * sizeof(*items));
+    if (!items) abort();
+
+    buffer->items = items;
+    buffer->capacity = capacity;
+  }
+
+  buffer->items[buffer->count++] = (aoc_trace_event){
+    name,
+    aoc_time_ns() - aoc_trace_epoch,
+    phase,
+  };
+}
+
+void aoc_trace_finish(void) {
+  aoc_trace_buffer *buffer, *next;
+  aoc_trace_event *e;
+  char const *sep = "";
+  FILE *file;
+  size_t i;
+
+  if (!aoc_trace_enabled) return;
+  aoc_trace_enabled = false;
+
+  if (!(file = fopen(aoc_trace_path, "w"))) {
+    fprintf(stderr, "could not open trace file '%s'\n", aoc_trace_path);
+    perror("reason");
+  }
+
+  if (file) fprintf(file, "{\"traceEvents\":[");
+
+  for (buffer = aoc_trace_buffers; buffer; buffer = next) {
+    for (i = 0; file && i < buffer->count; i++) {
+      e = &buffer->items[i];
+      fprintf(file, "%s\n{\"ph\":\"%c\",", sep, e->phase);
+      if (e->name) fprintf(file, "\"name\":\"%s\",", e->name);
+      fprintf(
+        file,
+        "\"ts\":%" PRIu64 ".%03" PRIu64 ",\"pid\":1,\"tid\":%zu}",
+        e->ts / 1000,
+        e->ts % 1000,
+        buffer->tid
+      );
+      sep = ",";
+    }
+
+    next = buffer->next;
+    free(buffer->items);
+    free(buffer);
+  }
+
+  if (file) {
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(file);
+    fprintf(stderr, "wrote trace to '%s'\n", aoc_trace_path);
+  }
+
+  aoc_trace_buffers = NULL;
+  aoc_trace_local = NULL;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Set while a trace is being recorded. Spans cost a single branch on this flag
+// when tracing is disabled.
+extern bool aoc_trace_enabled;
+
+// Start recording a trace that will be written to `path` by
+// `aoc_trace_finish`. If `path` is NULL, the AOC_TRACE environment variable is
+// used instead; if neither is set, tracing stays disabled.
+void aoc_trace_init(char const *path);
+
+// Write every recorded span to the trace file as Chrome trace event JSON (as
+// understood by chrome://tracing and Perfetto) and stop recording.
+void aoc_trace_finish(void);
+
+void aoc_trace_record(char const *name, char phase);
+
+// Open a span named `name` on the calling thread. `name` must outlive the
+// trace (string literals and registry names are fine). Spans nest, and every
+// call must be paired with `aoc_trace_end` on the same thread.
+static inline void aoc_trace_begin(char const *name) {
+  if (aoc_trace_enabled) aoc_trace_record(name, 'B');
+}
+
+// Close the innermost open span on the calling thread.
+static inline void aoc_trace_end(void) {
+  if (aoc_trace_enabled) aoc_trace_record(NULL, 'E');
+}
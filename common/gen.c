@@ -0,0 +1,50 @@
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "aoc-rng.h"
+
+// Write an input of size `scale` for one day to `out`. What the scale counts
+// (lines, grid size, vertices, ...) depends on the day. Errors are reported on
+// stderr.
+bool generate(FILE *out, uint64_t scale, aoc_rng *rng);
+
+static bool parse_u64(char const *text, uint64_t *value) {
+  char *end;
+  *value = strtoull(text, &end, 10);
+  return end != text && *end == '\0';
+}
+
+int main(int argc, char **argv) {
+  static char buffer[1 << 16];
+  uint64_t scale, seed = 1;
+  aoc_rng rng;
+
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr, "invalid number of arguments\n");
+    fprintf(stderr, "usage: %s [scale] [seed]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if (!parse_u64(argv[1], &scale) || scale == 0) {
+    fprintf(stderr, "invalid scale '%s'\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  if (argc > 2 && !parse_u64(argv[2], &seed)) {
+    fprintf(stderr, "invalid seed '%s'\n", argv[2]);
+    return EXIT_FAILURE;
+  }
+
+  setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+  aoc_rng_seed(&rng, seed);
+
+  if (!generate(stdout, scale, &rng)) return EXIT_FAILURE;
+  if (fflush(stdout) != 0) {
+    perror("failed to write input");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -1,80 +1,550 @@
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-void part1(char const *input);
-void part2(char const *input);
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "aoc-alloc.h"
+#include "aoc-array.h"
+#include "aoc-command.h"
+#include "aoc-input.h"
+#include "aoc-parse.h"
+#include "aoc-perf.h"
+#include "aoc-prefetch.h"
+#include "aoc-stream.h"
+#include "aoc-time.h"
+#include "aoc-trace.h"
+
+typedef uint64_t (*part_fn)(char const *input);
+
+uint64_t part1(char const *input);
+uint64_t part2(char const *input);
+
+// Days whose records can be processed one at a time may also provide streaming
+// entry points, which read the input through an aoc_stream instead.
+typedef uint64_t (*stream_fn)(aoc_stream *stream);
+
+uint64_t stream1(aoc_stream *stream) __attribute__((weak));
+uint64_t stream2(aoc_stream *stream) __attribute__((weak));
+
+// Days may also provide commands of their own.
+extern aoc_command const commands[] __attribute__((weak));
+
+static aoc_command const *select_command(char const *name) {
+  aoc_command const *command;
+
+  if (!commands) return NULL;
+  for (command = commands; command->name; command++) {
+    if (strcmp(command->name, name) == 0) return command;
+  }
+
+  return NULL;
+}
+
+static part_fn select_part(char const *spec) {
+  switch (spec[0]) {
+    case '1':
+      return part1;
+
+    case '2':
+      return part2;
+
+    default:
+      fprintf(stderr, "invalid part specifier '%s'\n", spec);
+      fprintf(stderr, "expected either '1' or '2'\n");
+      return NULL;
+  }
+}
+
+static stream_fn select_stream(char const *spec) {
+  stream_fn fn;
+
+  switch (spec[0]) {
+    case '1':
+      fn = stream1;
+      break;
+
+    case '2':
+      fn = stream2;
+      break;
+
+    default:
+      fprintf(stderr, "invalid part specifier '%s'\n", spec);
+      fprintf(stderr, "expected either '1' or '2'\n");
+      return NULL;
+  }
+
+  if (!fn) fprintf(stderr, "no streaming entry point for part %s\n", spec);
+  return fn;
+}
+
+// Return the nearest-rank percentile `pct` of the sorted `samples`.
+static uint64_t percentile(aoc_array const *samples, size_t pct) {
+  size_t rank = (samples->count * pct + 99) / 100;
+  return samples->items[rank ? rank - 1 : 0];
+}
+
+static int stream(char const *path, int argc, char **argv) {
+  int status = EXIT_FAILURE;
+  size_t chunk = AOC_STREAM_CHUNK;
+  aoc_stream input;
+  stream_fn part;
+  uint64_t start, answer, expected;
+  int arg;
+
+  if (argc < 1) {
+    fprintf(stderr, "missing part specifier for stream\n");
+    return EXIT_FAILURE;
+  }
+
+  if (!(part = select_stream(argv[0]))) return EXIT_FAILURE;
+
+  for (arg = 1; arg < argc; arg++) {
+    if (strcmp(argv[arg], "--chunk") != 0 || arg + 1 == argc) goto badarg;
+    if (!aoc_parse_count(argv[++arg], &chunk) || chunk == 0) goto badarg;
+  }
+
+  if (!aoc_stream_open(&input, path, chunk)) return EXIT_FAILURE;
+
+  aoc_trace_begin(argv[0][0] == '1' ? "stream1" : "stream2");
+  start = aoc_time_ns();
+  answer = part(&input);
+  aoc_trace_end();
+
+  fprintf(
+    stderr,
+    "streamed %" PRIu64 " bytes in %zu-byte chunks in %.3f ms\n",
+    input.bytes,
+    chunk,
+    aoc_time_ms(aoc_time_ns() - start)
+  );
+  if (input.failed) goto defer;
+
+  printf("\n\033[32m%" PRIu64 "\n\033[0m\n", answer);
+
+  if (aoc_input_expected(path, argv[0][0] - '0', &expected)) {
+    if (answer != expected) {
+      fprintf(stderr, "expected %" PRIu64 "\n", expected);
+      goto defer;
+    }
+    fprintf(stderr, "answer matches the expected value\n");
+  }
+
+  status = EXIT_SUCCESS;
+
+defer:
+  aoc_stream_close(&input);
+  return status;
+
+badarg:
+  fprintf(stderr, "invalid stream argument '%s'\n", argv[arg]);
+  fprintf(stderr, "expected '--chunk [bytes]'\n");
+  return EXIT_FAILURE;
+}
+
+static int bench(
+  aoc_input const *input,
+  char const *path,
+  int argc,
+  char **argv
+) {
+  size_t i, iters = 100, warmup = 5, wrong = 0;
+  aoc_array samples = {0};
+  aoc_perf perf;
+  aoc_perf_counts counts;
+  aoc_alloc_stats alloc = {0};
+  part_fn part;
+  uint64_t start, elapsed, answer, expected;
+  char *copy;
+  bool check, counters = false, allocs = false;
+
+  if (argc < 1) {
+    fprintf(stderr, "missing part specifier for bench\n");
+    return EXIT_FAILURE;
+  }
+
+  if (!(part = select_part(argv[0]))) return EXIT_FAILURE;
+
+  for (i = 1; i < (size_t)argc; i++) {
+    if (strcmp(argv[i], "--iters") == 0 && i + 1 < (size_t)argc) {
+      if (!aoc_parse_count(argv[++i], &iters)) goto badarg;
+    } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < (size_t)argc) {
+      if (!aoc_parse_count(argv[++i], &warmup)) goto badarg;
+    } else if (strcmp(argv[i], "--perf") == 0) {
+      counters = true;
+    } else if (strcmp(argv[i], "--alloc") == 0) {
+      allocs = true;
+    } else {
+      goto badarg;
+    }
+  }
+
+  if (iters == 0) {
+    fprintf(stderr, "bench needs at least one iteration\n");
+    return EXIT_FAILURE;
+  }
+
+  check = aoc_input_expected(path, argv[0][0] - '0', &expected);
+  if (counters) counters = aoc_perf_open(&perf);
+  if (counters) aoc_perf_reset(&perf);
+
+  aoc_array_ensure_capacity(&samples, iters);
+  for (i = 0; i < warmup + iters; i++) {
+    // Every iteration gets its own copy of the input so that no run benefits
+    // from the previous one having pulled the input into cache.
+    if (!(copy = malloc(input->length + 1))) abort();
+    memcpy(copy, input->data, input->length + 1);
+
+    aoc_trace_begin(argv[0][0] == '1' ? "part1" : "part2");
+    if (counters && i >= warmup) aoc_perf_enable(&perf);
+    if (allocs && i >= warmup) aoc_alloc_track(&alloc);
+    start = aoc_time_ns();
+    answer = part(copy);
+    elapsed = aoc_time_ns() - start;
+    if (allocs && i >= warmup) aoc_alloc_track(NULL);
+    if (counters && i >= warmup) aoc_perf_disable(&perf);
+    aoc_trace_end();
+
+    if (i >= warmup) aoc_array_push(&samples, elapsed);
+    wrong += check && answer != expected;
+
+    free(copy);
+  }
+
+  aoc_array_sort(&samples);
+  printf("part %s: %zu iterations (%zu warmup)\n", argv[0], iters, warmup);
+  printf("  answer %12" PRIu64, answer);
+  if (check) printf(" (%s)", wrong ? "WRONG" : "expected");
+  printf("\n");
+  printf("  min    %12.3f ms\n", aoc_time_ms(samples.items[0]));
+  printf("  median %12.3f ms\n", aoc_time_ms(percentile(&samples, 50)));
+  printf("  p90    %12.3f ms\n", aoc_time_ms(percentile(&samples, 90)));
+  printf("  p99    %12.3f ms\n", aoc_time_ms(percentile(&samples, 99)));
+  printf("  max    %12.3f ms\n", aoc_time_ms(percentile(&samples, 100)));
+
+  if (counters) {
+    aoc_perf_read(&perf, &counts);
+    aoc_perf_close(&perf);
+    printf("counters per iteration:\n");
+    aoc_perf_print(stdout, &counts, iters);
+  }
+
+  if (allocs) {
+    printf("allocations per iteration:\n");
+    aoc_alloc_print(stdout, &alloc, iters);
+  }
+
+  aoc_array_free(&samples);
+  if (wrong) {
+    fprintf(stderr, "%zu runs did not match the expected answer\n", wrong);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+
+badarg:
+  fprintf(stderr, "invalid bench argument '%s'\n", argv[i]);
+  fprintf(
+    stderr,
+    "expected '--iters [count]', '--warmup [count]', '--perf' or '--alloc'\n"
+  );
+  return EXIT_FAILURE;
+}
+
+AOC_ARRAY_STATIC(path_list, char *)
+
+// Push a copy of `path`, which the list owns until path_list_free_all.
+static void path_list_push_copy(path_list *list, char const *path) {
+  char *copy;
+
+  if (!(copy = strdup(path))) abort();
+  path_list_push(list, copy);
+}
+
+static void path_list_free_all(path_list *list) {
+  size_t i;
+
+  for (i = 0; i < list->count; i++) {
+    free(list->items[i]);
+  }
+  path_list_free(list);
+}
+
+static int path_compare(void const *lhs, void const *rhs) {
+  return strcmp(*(char *const *)lhs, *(char *const *)rhs);
+}
+
+static bool ends_with(char const *text, char const *suffix) {
+  size_t length = strlen(text), suffixlen = strlen(suffix);
+  return length >= suffixlen && strcmp(text + length - suffixlen, suffix) == 0;
+}
+
+// Add every input in `dir` to `list` in name order. Inputs are the "*.txt"
+// files other than the expected answers.
+static bool path_list_add_dir(path_list *list, char const *dir) {
+  char path[4096];
+  struct dirent *entry;
+  size_t first = list->count;
+  DIR *handle;
+
+  if (!(handle = opendir(dir))) {
+    fprintf(stderr, "could not open directory '%s'\n", dir);
+    perror("reason");
+    return false;
+  }
+
+  while ((entry = readdir(handle))) {
+    if (entry->d_name[0] == '.' || !ends_with(entry->d_name, ".txt")) continue;
+    if (strcmp(entry->d_name, "expected.txt") == 0) continue;
+    if (ends_with(entry->d_name, ".expected.txt")) continue;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+    path_list_push_copy(list, path);
+  }
+
+  closedir(handle);
+  qsort(list->items + first, list->count - first, sizeof(char *), path_compare);
+  return true;
+}
+
+// Add the inputs listed in the file at `path`, one per line.
+static bool path_list_add_list(path_list *list, char const *path) {
+  char *line = NULL;
+  size_t capacity = 0;
+  FILE *file;
+
+  if (!(file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r"))) {
+    fprintf(stderr, "could not open file list '%s'\n", path);
+    perror("reason");
+    return false;
+  }
+
+  while (getline(&line, &capacity, file) >= 0) {
+    line[strcspn(line, "\r\n")] = '\0';
+    if (line[0] != '\0') path_list_push_copy(list, line);
+  }
+
+  free(line);
+  if (file != stdin) fclose(file);
+  return true;
+}
+
+// Add the inputs named by a batch argument: a directory of inputs, a file
+// listing inputs when prefixed with '@' (or "@-" for stdin), or an input.
+static bool path_list_add(path_list *list, char const *arg) {
+  struct stat st;
+
+  if (arg[0] == '@') return path_list_add_list(list, arg + 1);
+  if (stat(arg, &st) == 0 && S_ISDIR(st.st_mode)) {
+    return path_list_add_dir(list, arg);
+  }
+
+  path_list_push_copy(list, arg);
+  return true;
+}
+
+static int batch(int argc, char **argv) {
+  int status = EXIT_FAILURE;
+  size_t i, wrong = 0, failed = 0;
+  path_list paths = {0};
+  aoc_prefetch prefetch;
+  aoc_input input;
+  uint64_t start, elapsed, wall, answer, expected;
+  char const *verdict;
+  part_fn part;
+  bool loaded;
+
+  if (argc < 2) {
+    fprintf(stderr, "batch needs a part and at least one input\n");
+    return EXIT_FAILURE;
+  }
+
+  if (!(part = select_part(argv[0]))) return EXIT_FAILURE;
+
+  for (i = 1; i < (size_t)argc; i++) {
+    if (!path_list_add(&paths, argv[i])) goto defer;
+  }
+
+  if (paths.count == 0) {
+    fprintf(stderr, "no inputs found\n");
+    goto defer;
+  }
+
+  // The next inputs are loaded in the background while the current one is
+  // being solved, so the loop below only ever waits on I/O if solving is
+  // faster than loading.
+  start = aoc_time_ns();
+  aoc_prefetch_start(&prefetch, (char const *const *)paths.items, paths.count);
+  for (i = 0; aoc_prefetch_next(&prefetch, &input, &loaded); i++) {
+    if (!loaded) {
+      printf("%s\t-\t-\tno input\n", paths.items[i]);
+      failed++;
+      continue;
+    }
+
+    aoc_trace_begin(argv[0][0] == '1' ? "part1" : "part2");
+    elapsed = aoc_time_ns();
+    answer = part(input.data);
+    elapsed = aoc_time_ns() - elapsed;
+    aoc_trace_end();
+
+    aoc_input_free(&input);
+
+    verdict = "unchecked";
+    if (aoc_input_expected(paths.items[i], argv[0][0] - '0', &expected)) {
+      verdict = answer == expected ? "ok" : "WRONG";
+      wrong += answer != expected;
+    }
+
+    printf(
+      "%s\t%" PRIu64 "\t%.3f\t%s\n",
+      paths.items[i],
+      answer,
+      aoc_time_ms(elapsed),
+      verdict
+    );
+  }
+  wall = aoc_time_ns() - start;
+  aoc_prefetch_stop(&prefetch);
+
+  fprintf(
+    stderr,
+    "%zu inputs in %.3f ms (%.1f inputs/s)\n",
+    paths.count,
+    aoc_time_ms(wall),
+    (double)paths.count / ((double)wall / 1e9)
+  );
+  if (failed) fprintf(stderr, "%zu inputs could not be loaded\n", failed);
+  if (wrong) fprintf(stderr, "%zu answers did not match\n", wrong);
+
+  if (!failed && !wrong) status = EXIT_SUCCESS;
+
+defer:
+  path_list_free_all(&paths);
+  return status;
+}
 
 int main(int argc, char **argv) {
   int status = EXIT_FAILURE;
-  char *input = NULL;
-  FILE *file = NULL;
-  long told;
-  size_t length;
-  
+  aoc_input input = {0};
+  uint64_t start, answer, expected;
+  aoc_perf perf;
+  aoc_perf_counts counts;
+  aoc_alloc_stats alloc = {0};
+  bool counters = false, allocs = false;
+  aoc_command const *command;
+  part_fn part;
+  int arg;
+
   if (argc < 3) {
     fprintf(stderr, "invalid number of arguments\n");
-    fprintf(stderr, "usage: %s [input] [part]\n", argv[0]);
+    fprintf(stderr, "usage: %s [input] [part] [--perf] [--alloc]\n", argv[0]);
+    fprintf(stderr, "       %s [input] bench [part] [options]\n", argv[0]);
+    fprintf(stderr, "       %s [input] stream [part] [options]\n", argv[0]);
+    fprintf(stderr, "       %s batch [part] [dir|@list|input]...\n", argv[0]);
+    for (command = commands; command && command->name; command++) {
+      fprintf(
+        stderr,
+        "       %s [input] %s%s%s\n",
+        argv[0],
+        command->name,
+        command->args[0] ? " " : "",
+        command->args
+      );
+    }
     goto defer;
   }
 
-  if (!(file = fopen(argv[1], "r"))) {
-    fprintf(stderr, "could not open file '%s'\n", argv[1]);
-    perror("reason");
+  aoc_trace_init(NULL);
+
+  if (strcmp(argv[1], "batch") == 0) {
+    status = batch(argc - 2, argv + 2);
     goto defer;
   }
 
-  if (fseek(file, 0, SEEK_END) < 0) {
-    fprintf(stderr, "seek failed for '%s'\n", argv[1]);
-    perror("reason");
+  // Streaming reads the input itself, a chunk at a time, instead of loading
+  // all of it up front.
+  if (strcmp(argv[2], "stream") == 0) {
+    status = stream(argv[1], argc - 3, argv + 3);
     goto defer;
   }
 
-  if ((told = ftell(file)) < 0) {
-    fprintf(stderr, "failed to get size of '%s'\n", argv[1]);
-    perror("reason");
+  aoc_trace_begin("load");
+  start = aoc_time_ns();
+  if (!aoc_input_load(&input, argv[1])) {
+    aoc_trace_end();
     goto defer;
   }
+  aoc_trace_end();
 
-  length = (size_t)told;
-  rewind(file);
+  fprintf(
+    stderr,
+    "loaded %zu bytes (%s) in %.3f ms\n",
+    input.length,
+    input.mapped ? "mapped" : "read",
+    aoc_time_ms(aoc_time_ns() - start)
+  );
 
-  if (!(input = malloc(length + 1))) {
-    fprintf(stderr, "failed to allocate %zu bytes\n", (size_t)(told + 1));
+  if (strcmp(argv[2], "bench") == 0) {
+    status = bench(&input, argv[1], argc - 3, argv + 3);
     goto defer;
   }
 
-  if (fread(input, 1, length, file) != length) {
-    fprintf(stderr, "failed to read '%s'\n", argv[1]);
-    perror("reason");
+  if ((command = select_command(argv[2]))) {
+    aoc_trace_begin(command->name);
+    status = command->run(input.data, argc - 3, argv + 3);
+    aoc_trace_end();
     goto defer;
   }
 
-  input[length] = '\0';
+  if (!(part = select_part(argv[2]))) goto defer;
 
+  for (arg = 3; arg < argc; arg++) {
+    if (strcmp(argv[arg], "--perf") == 0) {
+      counters = true;
+    } else if (strcmp(argv[arg], "--alloc") == 0) {
+      allocs = true;
+    } else {
+      fprintf(stderr, "invalid argument '%s'\n", argv[arg]);
+      goto defer;
+    }
+  }
 
-  switch (argv[2][0]) {
-    case '1':
-      printf("\n\033[32m");
-      part1(input);
-      printf("\033[0m\n");
-      break;
+  if (counters) counters = aoc_perf_open(&perf);
+  if (counters) {
+    aoc_perf_reset(&perf);
+    aoc_perf_enable(&perf);
+  }
 
-    case '2':
-      printf("\n\033[32m");
-      part2(input);
-      printf("\033[0m\n");
-      break;
+  aoc_trace_begin(argv[2][0] == '1' ? "part1" : "part2");
+  if (allocs) aoc_alloc_track(&alloc);
+  answer = part(input.data);
+  if (allocs) aoc_alloc_track(NULL);
+  aoc_trace_end();
 
-    default:
-      fprintf(stderr, "invalid part specifier '%s'\n", argv[2]);
-      fprintf(stderr, "expected either '1' or '2'\n");
+  if (counters) {
+    aoc_perf_disable(&perf);
+    aoc_perf_read(&perf, &counts);
+    aoc_perf_close(&perf);
+  }
+  printf("\n\033[32m%" PRIu64 "\n\033[0m\n", answer);
+
+  if (aoc_input_expected(argv[1], argv[2][0] - '0', &expected)) {
+    if (answer != expected) {
+      fprintf(stderr, "expected %" PRIu64 "\n", expected);
       goto defer;
+    }
+    fprintf(stderr, "answer matches the expected value\n");
   }
 
+  if (counters) aoc_perf_print(stderr, &counts, 1);
+  if (allocs) aoc_alloc_print(stderr, &alloc, 1);
+
   status = EXIT_SUCCESS;
 
 defer:
-  if (file) fclose(file);
-  free(input);
+  aoc_trace_finish();
+  aoc_input_free(&input);
   return status;
 }
@@ -0,0 +1,319 @@
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aoc-alloc.h"
+#include "aoc-input.h"
+#include "aoc-perf.h"
+#include "aoc-registry.h"
+#include "aoc-thread.h"
+#include "aoc-time.h"
+#include "aoc-trace.h"
+
+typedef enum job_status {
+  JOB_UNCHECKED,
+  JOB_CORRECT,
+  JOB_WRONG,
+  JOB_NOINPUT,
+} job_status;
+
+typedef struct job {
+  aoc_day const *day;
+  size_t part;
+  job_status status;
+  uint64_t answer;
+  uint64_t expected;
+  uint64_t load_ns;
+  uint64_t run_ns;
+  aoc_perf_counts counts;
+  aoc_alloc_stats alloc;
+} job;
+
+typedef struct sweep {
+  job *jobs;
+  size_t njobs;
+  atomic_size_t next;
+  char const *inputs;
+  bool counters;
+  bool allocs;
+} sweep;
+
+static void run_job(sweep const *s, job *j) {
+  aoc_input input;
+  aoc_perf perf;
+  char path[4096];
+  uint64_t start;
+  bool counters;
+
+  snprintf(path, sizeof(path), "%s/%s.txt", s->inputs, j->day->name);
+
+  aoc_trace_begin(j->day->name);
+  aoc_trace_begin("load");
+  start = aoc_time_ns();
+  if (!aoc_input_load(&input, path)) {
+    j->status = JOB_NOINPUT;
+    aoc_trace_end();
+    aoc_trace_end();
+    return;
+  }
+  j->load_ns = aoc_time_ns() - start;
+  aoc_trace_end();
+
+  // Counters are opened per job so that they only count the worker thread
+  // running this part (and any threads the part starts itself).
+  if ((counters = s->counters && aoc_perf_open(&perf))) {
+    aoc_perf_reset(&perf);
+    aoc_perf_enable(&perf);
+  }
+
+  aoc_trace_begin(j->part == 1 ? "part1" : "part2");
+  if (s->allocs) aoc_alloc_track(&j->alloc);
+  start = aoc_time_ns();
+  j->answer = j->day->parts[j->part - 1](input.data);
+  j->run_ns = aoc_time_ns() - start;
+  if (s->allocs) aoc_alloc_track(NULL);
+  aoc_trace_end();
+  aoc_trace_end();
+
+  if (counters) {
+    aoc_perf_disable(&perf);
+    aoc_perf_read(&perf, &j->counts);
+    aoc_perf_close(&perf);
+  }
+
+  if (aoc_input_expected(path, j->part, &j->expected)) {
+    j->status = j->answer == j->expected ? JOB_CORRECT : JOB_WRONG;
+  }
+
+  aoc_input_free(&input);
+}
+
+static void worker(void *ctx, size_t id, size_t count) {
+  sweep *s = ctx;
+  size_t i;
+
+  (void)id;
+  (void)count;
+
+  while ((i = atomic_fetch_add(&s->next, 1)) < s->njobs) {
+    run_job(s, &s->jobs[i]);
+  }
+}
+
+// Mark the days matched by `spec` in `selected`. A spec is either "all", a
+// single day such as "2025/05", or an inclusive range such as
+// "2025/05-2025/11".
+static bool select_days(char const *spec, bool *selected) {
+  char first[64], last[64];
+  char const *dash;
+  size_t i, matched = 0;
+
+  if (strcmp(spec, "all") == 0) {
+    snprintf(first, sizeof(first), "%s", "");
+    snprintf(last, sizeof(last), "%s", "~");
+  } else if ((dash = strchr(spec, '-'))) {
+    snprintf(first, sizeof(first), "%.*s", (int)(dash - spec), spec);
+    snprintf(last, sizeof(last), "%s", dash + 1);
+  } else {
+    snprintf(first, sizeof(first), "%s", spec);
+    snprintf(last, sizeof(last), "%s", spec);
+  }
+
+  for (i = 0; i < aoc_ndays; i++) {
+    if (strcmp(first, aoc_days[i].name) > 0) continue;
+    if (strcmp(aoc_days[i].name, last) > 0) continue;
+    selected[i] = true;
+    matched++;
+  }
+
+  if (matched == 0) {
+    fprintf(stderr, "no days match '%s'\n", spec);
+    return false;
+  }
+
+  return true;
+}
+
+static void print_rate(double rate, double scale) {
+  if (rate < 0) {
+    printf(" %8s", "-");
+  } else {
+    printf(" %8.2f", rate * scale);
+  }
+}
+
+static void print_counts(aoc_perf_counts const *counts) {
+  double rate;
+
+  rate = aoc_perf_ratio(counts, AOC_PERF_INSTRUCTIONS, AOC_PERF_CYCLES);
+  print_rate(rate, 1);
+
+  rate = aoc_perf_ratio(counts, AOC_PERF_BRANCH_MISSES, AOC_PERF_BRANCHES);
+  print_rate(rate, 100);
+
+  rate = aoc_perf_ratio(counts, AOC_PERF_L1D_MISSES, AOC_PERF_L1D_LOADS);
+  print_rate(rate, 100);
+
+  rate = aoc_perf_ratio(counts, AOC_PERF_LLC_MISSES, AOC_PERF_LLC_REFERENCES);
+  print_rate(rate, 100);
+}
+
+static void print_allocs(aoc_alloc_stats *alloc) {
+  printf(
+    " %10" PRIu64 " %10.1f",
+    (uint64_t)atomic_load(&alloc->allocs),
+    (double)atomic_load(&alloc->peak) / 1024
+  );
+}
+
+static bool print_jobs(job *jobs, size_t njobs, bool counters, bool allocs) {
+  bool ok = true;
+  size_t i;
+
+  printf(
+    "%-8s %4s %20s %10s %10s",
+    "day",
+    "part",
+    "answer",
+    "load ms",
+    "run ms"
+  );
+  if (counters) {
+    printf(" %8s %8s %8s %8s", "IPC", "br-miss%", "L1-miss%", "LLC-mis%");
+  }
+  if (allocs) printf(" %10s %10s", "allocs", "peak KiB");
+  printf("  status\n");
+
+  for (i = 0; i < njobs; i++) {
+    job *j = &jobs[i];
+
+    if (j->status == JOB_NOINPUT) {
+      printf("%-8s %4zu %20s %10s %10s", j->day->name, j->part, "-", "-", "-");
+      if (counters) printf(" %8s %8s %8s %8s", "-", "-", "-", "-");
+      if (allocs) printf(" %10s %10s", "-", "-");
+      printf("  no input\n");
+      ok = false;
+      continue;
+    }
+
+    printf(
+      "%-8s %4zu %20" PRIu64 " %10.3f %10.3f",
+      j->day->name,
+      j->part,
+      j->answer,
+      aoc_time_ms(j->load_ns),
+      aoc_time_ms(j->run_ns)
+    );
+    if (counters) print_counts(&j->counts);
+    if (allocs) print_allocs(&j->alloc);
+    printf("  ");
+
+    switch (j->status) {
+      case JOB_CORRECT:
+        printf("ok\n");
+        break;
+
+      case JOB_WRONG:
+        printf("WRONG (expected %" PRIu64 ")\n", j->expected);
+        ok = false;
+        break;
+
+      default:
+        printf("unchecked\n");
+        break;
+    }
+  }
+
+  return ok;
+}
+
+static void usage(char const *name) {
+  fprintf(stderr, "usage: %s [options] [all | day | first-last]...\n", name);
+  fprintf(stderr, "options:\n");
+  fprintf(stderr, "  -j [threads]  number of worker threads\n");
+  fprintf(stderr, "  -d [dir]      directory holding [year]/[day].txt\n");
+  fprintf(stderr, "  -t [file]     write a Chrome trace of the run to file\n");
+  fprintf(stderr, "  -p            measure hardware performance counters\n");
+  fprintf(stderr, "  -a            count allocations and peak heap usage\n");
+}
+
+int main(int argc, char **argv) {
+  int status = EXIT_FAILURE;
+  bool *selected = NULL;
+  size_t threads = aoc_thread_count();
+  size_t i, part, nspecs = 0;
+  char const *trace = NULL;
+  sweep s = {.inputs = "."};
+  aoc_perf probe;
+  uint64_t start, wall;
+  int arg;
+
+  if (!(selected = calloc(aoc_ndays, sizeof(*selected)))) abort();
+
+  for (arg = 1; arg < argc; arg++) {
+    if (strcmp(argv[arg], "-j") == 0 && arg + 1 < argc) {
+      threads = strtoul(argv[++arg], NULL, 10);
+      if (threads == 0) threads = 1;
+    } else if (strcmp(argv[arg], "-d") == 0 && arg + 1 < argc) {
+      s.inputs = argv[++arg];
+    } else if (strcmp(argv[arg], "-t") == 0 && arg + 1 < argc) {
+      trace = argv[++arg];
+    } else if (strcmp(argv[arg], "-p") == 0) {
+      s.counters = true;
+    } else if (strcmp(argv[arg], "-a") == 0) {
+      s.allocs = true;
+    } else if (argv[arg][0] == '-') {
+      usage(argv[0]);
+      goto defer;
+    } else {
+      if (!select_days(argv[arg], selected)) goto defer;
+      nspecs++;
+    }
+  }
+
+  if (nspecs == 0) {
+    usage(argv[0]);
+    goto defer;
+  }
+
+  if (!(s.jobs = calloc(aoc_ndays * 2, sizeof(*s.jobs)))) abort();
+  for (i = 0; i < aoc_ndays; i++) {
+    if (!selected[i]) continue;
+    for (part = 1; part <= 2; part++) {
+      s.jobs[s.njobs++] = (job){&aoc_days[i], part};
+    }
+  }
+
+  if (threads > s.njobs) threads = s.njobs;
+
+  // Probe the counters once up front so that a system without them is only
+  // reported once instead of once per job.
+  if (s.counters) {
+    s.counters = aoc_perf_open(&probe);
+    if (s.counters) aoc_perf_close(&probe);
+  }
+
+  aoc_trace_init(trace);
+
+  start = aoc_time_ns();
+  aoc_parallel(threads, worker, &s);
+  wall = aoc_time_ns() - start;
+
+  aoc_trace_finish();
+
+  if (print_jobs(s.jobs, s.njobs, s.counters, s.allocs)) status = EXIT_SUCCESS;
+  printf(
+    "\n%zu parts on %zu threads in %.3f ms\n",
+    s.njobs,
+    threads,
+    aoc_time_ms(wall)
+  );
+
+defer:
+  free(s.jobs);
+  free(selected);
+  return status;
+}
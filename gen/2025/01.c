@@ -0,0 +1,23 @@
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <aoc-rng.h>
+
+// One rotation per line, e.g. "L68". Distances go up to 999 so that a single
+// rotation can pass zero several times.
+bool generate(FILE *out, uint64_t scale, aoc_rng *rng) {
+  uint64_t i;
+
+  for (i = 0; i < scale; i++) {
+    fprintf(
+      out,
+      "%c%" PRIu64 "\n",
+      aoc_rng_chance(rng, 1, 2) ? 'L' : 'R',
+      aoc_rng_range(rng, 1, 999)
+    );
+  }
+
+  return true;
+}
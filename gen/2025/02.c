@@ -0,0 +1,57 @@
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <aoc-rng.h>
+
+typedef struct range {
+  uint64_t min;
+  uint64_t max;
+} range;
+
+static uint64_t power10(uint64_t exponent) {
+  uint64_t value = 1;
+  while (exponent--) value *= 10;
+  return value;
+}
+
+// `scale` disjoint id ranges on a single comma-separated line, in random
+// order. Gaps and widths vary over several orders of magnitude so that the
+// ranges cover numbers of many different lengths.
+bool generate(FILE *out, uint64_t scale, aoc_rng *rng) {
+  uint64_t i, j, gap, width, next = 10;
+  range *ranges, swap;
+
+  if (!(ranges = malloc(scale * sizeof(*ranges)))) abort();
+
+  for (i = 0; i < scale; i++) {
+    gap = power10(aoc_rng_range(rng, 1, 9));
+    width = power10(aoc_rng_range(rng, 1, 7));
+    ranges[i].min = next + aoc_rng_range(rng, 1, gap);
+    ranges[i].max = ranges[i].min + aoc_rng_range(rng, 1, width);
+    next = ranges[i].max + 1;
+  }
+
+  for (i = scale - 1; i > 0; i--) {
+    j = aoc_rng_below(rng, i + 1);
+    swap = ranges[i];
+    ranges[i] = ranges[j];
+    ranges[j] = swap;
+  }
+
+  for (i = 0; i < scale; i++) {
+    fprintf(
+      out,
+      "%s%" PRIu64 "-%" PRIu64,
+      i ? "," : "",
+      ranges[i].min,
+      ranges[i].max
+    );
+  }
+  fprintf(out, "\n");
+
+  free(ranges);
+  return true;
+}
@@ -0,0 +1,23 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <aoc-rng.h>
+
+#define LINE_LENGTH (100)
+
+// `scale` banks of 100 batteries, one digit from 1 to 9 each.
+bool generate(FILE *out, uint64_t scale, aoc_rng *rng) {
+  char line[LINE_LENGTH + 1];
+  uint64_t i, j;
+
+  for (i = 0; i < scale; i++) {
+    for (j = 0; j < LINE_LENGTH; j++) {
+      line[j] = (char)('1' + aoc_rng_below(rng, 9));
+    }
+    line[LINE_LENGTH] = '\n';
+    fwrite(line, 1, sizeof(line), out);
+  }
+
+  return true;
+}
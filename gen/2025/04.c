@@ -0,0 +1,25 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <aoc-rng.h>
+
+// A `scale` x `scale` grid where three in four cells hold a roll of paper.
+bool generate(FILE *out, uint64_t scale, aoc_rng *rng) {
+  char *line;
+  uint64_t x, y;
+
+  if (!(line = malloc(scale + 1))) abort();
+
+  for (y = 0; y < scale; y++) {
+    for (x = 0; x < scale; x++) {
+      line[x] = aoc_rng_chance(rng, 3, 4) ? '@' : '.';
+    }
+    line[scale] = '\n';
+    fwrite(line, 1, scale + 1, out);
+  }
+
+  free(line);
+  return true;
+}
@@ -0,0 +1,34 @@
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <aoc-rng.h>
+
+#define MAX_ID (100000000000000)
+#define IDS_PER_RANGE (5)
+
+// `scale` possibly overlapping ranges of fresh ids, a blank line, then five
+// times as many ingredient ids to look up. Range widths shrink as the scale
+// grows, so that about a fifth of the ids are fresh at any scale.
+bool generate(FILE *out, uint64_t scale, aoc_rng *rng) {
+  uint64_t i, min, width = MAX_ID / scale / 2;
+
+  for (i = 0; i < scale; i++) {
+    min = aoc_rng_range(rng, 1, MAX_ID);
+    fprintf(
+      out,
+      "%" PRIu64 "-%" PRIu64 "\n",
+      min,
+      min + aoc_rng_range(rng, 0, width)
+    );
+  }
+
+  fprintf(out, "\n");
+
+  for (i = 0; i < scale * IDS_PER_RANGE; i++) {
+    fprintf(out, "%" PRIu64 "\n", aoc_rng_range(rng, 1, MAX_ID));
+  }
+
+  return true;
+}
@@ -0,0 +1,69 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <aoc-rng.h>
+
+#define OPERANDS (4)
+
+typedef struct problem {
+  uint16_t operands[OPERANDS];
+  bool left[OPERANDS];
+  int width;
+  char op;
+} problem;
+
+static int digits(uint16_t value) {
+  int count = 1;
+  while (value >= 10) value /= 10, count++;
+  return count;
+}
+
+// `scale` problems side by side, each with four operands of up to four digits
+// stacked above an operator. Operands are randomly aligned to the left or the
+// right of their column, which matters when the columns are read vertically.
+// Products reach 10^16, so the grand totals wrap around 2^64 somewhere past a
+// thousand problems.
+bool generate(FILE *out, uint64_t scale, aoc_rng *rng) {
+  problem *problems;
+  uint64_t i;
+  size_t row;
+
+  if (!(problems = malloc(scale * sizeof(*problems)))) abort();
+
+  for (i = 0; i < scale; i++) {
+    problem *p = &problems[i];
+    p->width = 0;
+    for (row = 0; row < OPERANDS; row++) {
+      p->operands[row] = (uint16_t)aoc_rng_range(rng, 1, 9999);
+      p->left[row] = aoc_rng_chance(rng, 1, 2);
+      if (digits(p->operands[row]) > p->width) {
+        p->width = digits(p->operands[row]);
+      }
+    }
+    p->op = aoc_rng_chance(rng, 1, 2) ? '+' : '*';
+  }
+
+  for (row = 0; row < OPERANDS; row++) {
+    for (i = 0; i < scale; i++) {
+      problem *p = &problems[i];
+      fprintf(
+        out,
+        p->left[row] ? "%s%-*u" : "%s%*u",
+        i ? " " : "",
+        p->width,
+        p->operands[row]
+      );
+    }
+    fprintf(out, "\n");
+  }
+
+  for (i = 0; i < scale; i++) {
+    fprintf(out, "%s%-*c", i ? " " : "", problems[i].width, problems[i].op);
+  }
+  fprintf(out, "\n");
+
+  free(problems);
+  return true;
+}
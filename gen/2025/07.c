@@ -0,0 +1,35 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <aoc-rng.h>
+
+// A `scale` x `scale` manifold (rounded up to an odd width) with the start in
+// the middle of the top row. Every other row holds splitters, never on the
+// edges, so a split beam always stays inside the grid. Past a few hundred rows
+// the number of timelines in part 2 no longer fits in 64 bits.
+bool generate(FILE *out, uint64_t scale, aoc_rng *rng) {
+  uint64_t width = scale < 3 ? 3 : scale | 1;
+  uint64_t x, y;
+  char *line;
+
+  if (!(line = malloc(width + 1))) abort();
+  line[width] = '\n';
+
+  memset(line, '.', width);
+  line[width / 2] = 'S';
+  fwrite(line, 1, width + 1, out);
+
+  for (y = 1; y < width; y++) {
+    memset(line, '.', width);
+    for (x = 1; y % 2 == 0 && x + 1 < width; x++) {
+      if (aoc_rng_chance(rng, 15, 100)) line[x] = '^';
+    }
+    fwrite(line, 1, width + 1, out);
+  }
+
+  free(line);
+  return true;
+}
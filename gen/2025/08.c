@@ -0,0 +1,32 @@
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <aoc-rng.h>
+
+#define MAX_COORD (99999)
+
+// Part 1 connects the 1000 closest pairs of boxes.
+#define PART1_PAIRS (1000)
+
+// `scale` junction boxes at random positions in a 100000^3 cube.
+bool generate(FILE *out, uint64_t scale, aoc_rng *rng) {
+  uint64_t i;
+
+  if (scale * (scale - 1) / 2 < PART1_PAIRS) {
+    fprintf(stderr, "warning: part 1 needs at least 46 junction boxes\n");
+  }
+
+  for (i = 0; i < scale; i++) {
+    fprintf(
+      out,
+      "%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+      aoc_rng_range(rng, 0, MAX_COORD),
+      aoc_rng_range(rng, 0, MAX_COORD),
+      aoc_rng_range(rng, 0, MAX_COORD)
+    );
+  }
+
+  return true;
+}
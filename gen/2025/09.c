@@ -0,0 +1,58 @@
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <aoc-rng.h>
+
+#define HEIGHT (100000)
+#define MAX_STEP (200)
+
+// Pick a value in [min, max] that differs from `prev`, so that consecutive
+// edges always turn and no vertex lies in the middle of a straight line.
+static uint64_t pick(aoc_rng *rng, uint64_t min, uint64_t max, uint64_t prev) {
+  uint64_t value;
+  do {
+    value = aoc_rng_range(rng, min, max);
+  } while (value == prev);
+  return value;
+}
+
+// A rectilinear polygon with `scale` red tiles (rounded down to a multiple of
+// four) as its vertices, in order around the boundary. The polygon is a row of
+// `scale / 4` columns; each column's top lies in the upper half and its
+// bottom in the lower half, so neighbouring columns always overlap and the
+// boundary never crosses itself.
+bool generate(FILE *out, uint64_t scale, aoc_rng *rng) {
+  uint64_t columns = scale < 4 ? 1 : scale / 4;
+  uint64_t *xs, *tops, *bottoms;
+  uint64_t i;
+
+  xs = malloc((columns + 1) * sizeof(*xs));
+  tops = malloc(columns * sizeof(*tops));
+  bottoms = malloc(columns * sizeof(*bottoms));
+  if (!xs || !tops || !bottoms) abort();
+
+  xs[0] = aoc_rng_range(rng, 0, MAX_STEP);
+  for (i = 0; i < columns; i++) {
+    xs[i + 1] = xs[i] + aoc_rng_range(rng, 1, MAX_STEP);
+    tops[i] = pick(rng, HEIGHT / 2 + 1, HEIGHT, i ? tops[i - 1] : 0);
+    bottoms[i] = pick(rng, 0, HEIGHT / 2 - 1, i ? bottoms[i - 1] : HEIGHT);
+  }
+
+  // Walk the top edge from left to right, then the bottom edge back.
+  for (i = 0; i < columns; i++) {
+    fprintf(out, "%" PRIu64 ",%" PRIu64 "\n", xs[i], tops[i]);
+    fprintf(out, "%" PRIu64 ",%" PRIu64 "\n", xs[i + 1], tops[i]);
+  }
+  for (i = columns; i-- > 0;) {
+    fprintf(out, "%" PRIu64 ",%" PRIu64 "\n", xs[i + 1], bottoms[i]);
+    fprintf(out, "%" PRIu64 ",%" PRIu64 "\n", xs[i], bottoms[i]);
+  }
+
+  free(bottoms);
+  free(tops);
+  free(xs);
+  return true;
+}
@@ -0,0 +1,70 @@
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <aoc-rng.h>
+
+// Limits of the solution: lights are numbered with a single digit and a
+// machine has at most MAX_BUTTONS buttons, which are the only limits its
+// parser has. Machines get anywhere from one button per light up to that.
+#define MIN_TARGETS (4)
+#define MAX_TARGETS (10)
+#define MAX_BUTTONS (20)
+#define MAX_PRESSES (20)
+
+// `scale` machines. The joltage targets are made by pressing each button a
+// random number of times and the indicator pattern by pressing a random subset
+// of the buttons once, so every machine is solvable in both parts.
+bool generate(FILE *out, uint64_t scale, aoc_rng *rng) {
+  uint16_t buttons[MAX_BUTTONS];
+  uint64_t joltages[MAX_TARGETS];
+  uint16_t indicators, presses;
+  size_t ntargets, nbuttons, i, j;
+  uint64_t machine;
+
+  for (machine = 0; machine < scale; machine++) {
+    ntargets = aoc_rng_range(rng, MIN_TARGETS, MAX_TARGETS);
+    nbuttons = aoc_rng_range(rng, ntargets, MAX_BUTTONS);
+    indicators = 0;
+
+    for (i = 0; i < ntargets; i++) {
+      joltages[i] = 0;
+    }
+
+    for (i = 0; i < nbuttons; i++) {
+      do {
+        buttons[i] = aoc_rng_below(rng, 1 << ntargets);
+      } while (buttons[i] == 0);
+
+      presses = aoc_rng_range(rng, 0, MAX_PRESSES);
+      for (j = 0; j < ntargets; j++) {
+        if (buttons[i] & (1 << j)) joltages[j] += presses;
+      }
+      if (aoc_rng_chance(rng, 1, 2)) indicators ^= buttons[i];
+    }
+
+    fprintf(out, "[");
+    for (i = 0; i < ntargets; i++) {
+      fprintf(out, "%c", indicators & (1 << i) ? '#' : '.');
+    }
+    fprintf(out, "]");
+
+    for (i = 0; i < nbuttons; i++) {
+      fprintf(out, " ");
+      for (j = 0; j < ntargets; j++) {
+        if (!(buttons[i] & (1 << j))) continue;
+        fprintf(out, "%c%zu", buttons[i] & ((1 << j) - 1) ? ',' : '(', j);
+      }
+      fprintf(out, ")");
+    }
+
+    fprintf(out, " {");
+    for (i = 0; i < ntargets; i++) {
+      fprintf(out, "%s%" PRIu64, i ? "," : "", joltages[i]);
+    }
+    fprintf(out, "}\n");
+  }
+
+  return true;
+}
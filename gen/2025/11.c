@@ -0,0 +1,133 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <aoc-rng.h>
+
+// Ids are three lowercase letters.
+#define MAXIDS (26 * 26 * 26)
+
+// Every device outputs to the next device in topological order, plus up to
+// MAX_EXTRA more devices at most WINDOW places further along.
+#define MAX_EXTRA (2)
+#define WINDOW (20)
+
+#define arrlen(array) (sizeof(array) / sizeof((array)[0]))
+
+static uint16_t id_from_text(char const text[3]) {
+  uint16_t id = text[0] - 'a';
+  id = id * 26 + text[1] - 'a';
+  id = id * 26 + text[2] - 'a';
+  return id;
+}
+
+static void print_id(FILE *out, uint16_t id) {
+  fprintf(out, "%c%c%c", 'a' + id / 676, 'a' + id / 26 % 26, 'a' + id % 26);
+}
+
+static void shuffle(aoc_rng *rng, uint16_t *items, size_t count) {
+  size_t i, j;
+  uint16_t swap;
+
+  for (i = count; i > 1; i--) {
+    j = aoc_rng_below(rng, i);
+    swap = items[i - 1];
+    items[i - 1] = items[j];
+    items[j] = swap;
+  }
+}
+
+// Return where the `which`th named device goes among `count` devices.
+static size_t named_slot(size_t which, size_t count) {
+  switch (which) {
+    case 0:
+      return 0;
+
+    case 1:
+      return count / 4;
+
+    case 2:
+      return count / 3;
+
+    case 3:
+      return count * 2 / 3;
+
+    default:
+      return count - 1;
+  }
+}
+
+// A random DAG of `scale` devices (at most one per possible id). The devices
+// are laid out in topological order with svr first and out last; you, fft and
+// dac sit a quarter, a third and two thirds of the way along. The chain of
+// "next device" edges makes every later device reachable from every earlier
+// one, so both parts always have paths. The number of paths grows
+// exponentially with the size of the graph; past a few hundred devices the
+// answers wrap around 2^64, like the solution's own arithmetic.
+bool generate(FILE *out, uint64_t scale, aoc_rng *rng) {
+  static char const *named[] = {"svr", "you", "fft", "dac", "out"};
+  uint16_t *ids, *devices, *lines;
+  size_t count, i, j, k, ndsts, slots[arrlen(named)], dsts[1 + MAX_EXTRA];
+
+  count = scale < arrlen(named) ? arrlen(named) : scale;
+  if (count > MAXIDS) count = MAXIDS;
+
+  ids = malloc(MAXIDS * sizeof(*ids));
+  devices = malloc(count * sizeof(*devices));
+  lines = malloc(count * sizeof(*lines));
+  if (!ids || !devices || !lines) abort();
+
+  // Shuffle the unnamed ids to pick the rest of the devices from.
+  for (i = k = 0; i < MAXIDS; i++) {
+    for (j = 0; j < arrlen(named) && id_from_text(named[j]) != i; j++) {}
+    if (j == arrlen(named)) ids[k++] = (uint16_t)i;
+  }
+  shuffle(rng, ids, k);
+
+  // Place the named devices, keeping them in order even in tiny graphs, and
+  // fill the gaps between them with the shuffled ids.
+  for (i = 0; i < arrlen(named); i++) {
+    slots[i] = named_slot(i, count);
+    if (i > 0 && slots[i] <= slots[i - 1]) slots[i] = slots[i - 1] + 1;
+  }
+
+  for (i = j = k = 0; i < count; i++) {
+    if (j < arrlen(named) && i == slots[j]) {
+      devices[i] = id_from_text(named[j++]);
+    } else {
+      devices[i] = ids[k++];
+    }
+  }
+
+  // List the devices in random order; out is last and has no outputs.
+  for (i = 0; i + 1 < count; i++) {
+    lines[i] = (uint16_t)i;
+  }
+  shuffle(rng, lines, count - 1);
+
+  for (i = 0; i + 1 < count; i++) {
+    dsts[0] = lines[i] + 1;
+    ndsts = 1;
+
+    for (j = aoc_rng_range(rng, 0, MAX_EXTRA); j > 0; j--) {
+      dsts[ndsts] = lines[i] + 1 + aoc_rng_range(rng, 1, WINDOW);
+      if (dsts[ndsts] >= count) continue;
+      for (k = 0; k < ndsts && dsts[k] != dsts[ndsts]; k++) {}
+      if (k == ndsts) ndsts++;
+    }
+
+    print_id(out, devices[lines[i]]);
+    fprintf(out, ":");
+    for (k = 0; k < ndsts; k++) {
+      fprintf(out, " ");
+      print_id(out, devices[dsts[k]]);
+    }
+    fprintf(out, "\n");
+  }
+
+  free(lines);
+  free(devices);
+  free(ids);
+  return true;
+}